@@ -0,0 +1,390 @@
+#include "../src/plugin.hpp"
+#include <chrono>
+#if defined ARCH_X64
+#include <x86intrin.h>
+#endif
+
+/**
+	Offline benchmark for the modules' process()-functions, run by "make bench".
+
+	The benchmark sets up a headless Rack context (engine only, no window or scene), creates the
+	modules of this plugin through their models and calls process() directly for a fixed number
+	of frames. All inputs of a module are "connected" with the configured number of channels and
+	are driven by a precomputed test signal. The overhead of driving the inputs is measured
+	separately and subtracted from the results.
+
+	Usage: bench [-f <million frames>] [-m <model slug>] [-csv]
+**/
+
+namespace StoermelderPackOne {
+namespace Bench {
+
+static const int BENCH_MIDI_DRIVER_ID = 7373;
+static const int SIGNAL_LENGTH = 1024;
+
+static float testSignal[SIGNAL_LENGTH];
+
+/** Reads the CPU's time-stamp counter. Notice this is the invariant TSC on modern x86 CPUs,
+	so it counts reference cycles at nominal frequency rather than actual core cycles. */
+static inline uint64_t readCycles() {
+#if defined ARCH_X64
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+
+struct BenchMidiInputDevice : midi::InputDevice {
+	std::string getName() override {
+		return "Bench";
+	}
+};
+
+/** MIDI driver with a single input device, used for feeding messages into the modules' midi::InputQueue. */
+struct BenchMidiDriver : midi::Driver {
+	BenchMidiInputDevice device;
+
+	std::string getName() override {
+		return "Bench";
+	}
+	std::vector<int> getInputDeviceIds() override {
+		return {0};
+	}
+	std::string getInputDeviceName(int deviceId) override {
+		return device.getName();
+	}
+	midi::InputDevice* subscribeInput(int deviceId, midi::Input* input) override {
+		device.subscribe(input);
+		return &device;
+	}
+	void unsubscribeInput(int deviceId, midi::Input* input) override {
+		device.unsubscribe(input);
+	}
+};
+
+static BenchMidiDriver* midiDriver = NULL;
+
+
+struct BenchEnv {
+	/** Additional modules needed by the module under test, e.g. as mapping targets */
+	std::vector<Module*> modules;
+
+	Module* addModule(std::string modelSlug) {
+		Model* model = pluginInstance->getModel(modelSlug);
+		Module* m = model->createModule();
+		m->id = 1 + modules.size();
+		APP->engine->addModule(m);
+		modules.push_back(m);
+		return m;
+	}
+
+	/** Applies the JSON-patch on the module's current data, as loading a patch would do */
+	void patchData(Module* m, std::function<void(json_t*)> f) {
+		json_t* dataJ = m->dataToJson();
+		if (!dataJ) dataJ = json_object();
+		f(dataJ);
+		m->dataFromJson(dataJ);
+		json_decref(dataJ);
+	}
+
+	/** Maps up to maxCount parameters of the target module by a "maps"-array in the format used by MapModuleBase and MIDI-CAT */
+	void patchMaps(Module* m, Module* target, int maxCount, std::function<void(json_t*, int)> f) {
+		patchData(m, [=](json_t* dataJ) {
+			json_t* mapsJ = json_array();
+			for (int i = 0; i < maxCount && i < (int)target->params.size(); i++) {
+				json_t* mapJ = json_object();
+				json_object_set_new(mapJ, "moduleId", json_integer(target->id));
+				json_object_set_new(mapJ, "paramId", json_integer(i));
+				f(mapJ, i);
+				json_array_append_new(mapsJ, mapJ);
+			}
+			json_object_set_new(dataJ, "maps", mapsJ);
+		});
+	}
+
+	void clear() {
+		for (auto it = modules.rbegin(); it != modules.rend(); ++it) {
+			APP->engine->removeModule(*it);
+			delete *it;
+		}
+		modules.clear();
+	}
+};
+
+
+struct BenchCase {
+	std::string modelSlug;
+	/** Optional description of the configuration */
+	std::string variant;
+	/** Number of channels on all inputs */
+	int channels;
+	/** Optional, called after the module has been added to the engine */
+	std::function<void(Module*, BenchEnv&)> setup;
+	/** Optional, called before each frame, e.g. for sending MIDI messages */
+	std::function<void(Module*, int64_t)> step;
+};
+
+struct BenchResult {
+	double nsPerSample;
+	double cyclesPerSample;
+};
+
+
+static void sendCc(int64_t frame) {
+	// Simulates a motorized fader bank: one message every 32 frames, cycling through the CCs
+	if (frame % 32 != 0) return;
+	int i = frame / 32;
+	midi::Message msg;
+	msg.setStatus(0xb);
+	msg.setChannel(0);
+	msg.setNote(i % 128);
+	msg.setValue((i / 128) % 128);
+	msg.setFrame(frame);
+	midiDriver->device.onMessage(msg);
+}
+
+/**
+	Models left out deliberately:
+	- Transit, EightFaceMk2: snapshots are applied on slot changes only, a benchmark of a fixed state
+	  measures the idle path. Both need a chain of expanders and stored slots for anything else.
+	- ReMoveLite: plays a recorded sequence into a mapped parameter, which needs a recording first.
+	- Intermix 16x16 and 32x32: there are no such models yet, only the 8x8 one is registered.
+	- All other models are utilities, MIDI-only or UI-driven modules without a notable process() load.
+**/
+static std::vector<BenchCase> benchCases() {
+	std::vector<BenchCase> cases;
+
+	// INTERMIX: diagonal routing, all inputs connected
+	auto intermixSetup = [](int channels) {
+		return [=](Module* m, BenchEnv& env) {
+			env.patchData(m, [=](json_t* dataJ) {
+				json_object_set_new(dataJ, "channelCount", json_integer(channels));
+			});
+			// PARAM_MATRIX is the first param-enum of an 8x8 matrix
+			for (int i = 0; i < 8; i++) {
+				m->params[i * 8 + i].setValue(1.f);
+			}
+		};
+	};
+	cases.push_back({"Intermix", "", 1, intermixSetup(1), NULL});
+	cases.push_back({"Intermix", "", 16, intermixSetup(16), NULL});
+
+	cases.push_back({"Arena", "", 1, NULL, NULL});
+	// ARENA: all in-ports as polyphonic voices, all mix-ports with polyphonic output
+	cases.push_back({"Arena", "poly", 16,
+		[](Module* m, BenchEnv& env) {
+			env.patchData(m, [](json_t* dataJ) {
+				json_t* portJ;
+				size_t i;
+				json_array_foreach(json_object_get(dataJ, "inports"), i, portJ) {
+					json_object_set_new(portJ, "inputPoly", json_true());
+				}
+				json_array_foreach(json_object_get(dataJ, "mixports"), i, portJ) {
+					json_object_set_new(portJ, "mixportPoly", json_true());
+				}
+			});
+		},
+		NULL
+	});
+	cases.push_back({"Raw", "", 1, NULL, NULL});
+	cases.push_back({"Raw", "", 16, NULL, NULL});
+	// RAW: oversampled processing
+	auto rawSetup = [](int oversample) {
+		return [=](Module* m, BenchEnv& env) {
+			env.patchData(m, [=](json_t* dataJ) {
+				json_object_set_new(dataJ, "oversample", json_integer(oversample));
+			});
+		};
+	};
+	cases.push_back({"Raw", "2x", 16, rawSetup(2), NULL});
+	cases.push_back({"Raw", "4x", 16, rawSetup(4), NULL});
+	cases.push_back({"Dirt", "", 1, NULL, NULL});
+	cases.push_back({"Dirt", "", 16, NULL, NULL});
+	cases.push_back({"Orbit", "", 1, NULL, NULL});
+	cases.push_back({"Orbit", "", 16, NULL, NULL});
+	cases.push_back({"Sipo", "", 1, NULL, NULL});
+	// SIPO: one register per channel of the SRC-port
+	cases.push_back({"Sipo", "", 16, NULL, NULL});
+
+	// CV-MAP: all 32 slots mapped to the parameters of an ARENA, default and audio rate processing
+	auto cvMapSetup = [](bool audioRate) {
+		return [=](Module* m, BenchEnv& env) {
+			Module* target = env.addModule("Arena");
+			env.patchMaps(m, target, 32, [](json_t* mapJ, int i) {
+				json_object_set_new(mapJ, "input", json_integer(i));
+			});
+			env.patchData(m, [=](json_t* dataJ) {
+				json_object_set_new(dataJ, "audioRate", json_boolean(audioRate));
+			});
+		};
+	};
+	cases.push_back({"CVMap", "", 16, cvMapSetup(false), NULL});
+	cases.push_back({"CVMap", "audio rate", 16, cvMapSetup(true), NULL});
+
+	// MIDI-CAT: all parameters of an ARENA mapped to CCs, with incoming MIDI traffic
+	cases.push_back({"MidiCat", "", 1,
+		[](Module* m, BenchEnv& env) {
+			Module* target = env.addModule("Arena");
+			env.patchMaps(m, target, 128, [](json_t* mapJ, int i) {
+				json_object_set_new(mapJ, "cc", json_integer(i % 128));
+			});
+			env.patchData(m, [](json_t* dataJ) {
+				json_t* midiInputJ = json_object();
+				json_object_set_new(midiInputJ, "driver", json_integer(BENCH_MIDI_DRIVER_ID));
+				json_object_set_new(midiInputJ, "deviceName", json_string("Bench"));
+				json_object_set_new(midiInputJ, "channel", json_integer(-1));
+				json_object_set_new(dataJ, "midiInput", midiInputJ);
+			});
+		},
+		[](Module* m, int64_t frame) {
+			sendCc(frame);
+		}
+	});
+
+	return cases;
+}
+
+
+static inline void driveInputs(Module* m, int channels, int64_t frame) {
+	for (size_t i = 0; i < m->inputs.size(); i++) {
+		Input& in = m->inputs[i];
+		for (int c = 0; c < channels; c++) {
+			in.voltages[c] = testSignal[(frame + c * 61 + i * 17) & (SIGNAL_LENGTH - 1)];
+		}
+	}
+}
+
+static BenchResult runCase(const BenchCase& bc, int64_t frames) {
+	BenchEnv env;
+	Module* m = env.addModule(bc.modelSlug);
+	for (Input& in : m->inputs) {
+		in.channels = bc.channels;
+	}
+	// Outputs need at least one channel, otherwise they report as disconnected
+	for (Output& out : m->outputs) {
+		out.channels = 1;
+	}
+	if (bc.setup) bc.setup(m, env);
+
+	Module::ProcessArgs args;
+	args.sampleRate = APP->engine->getSampleRate();
+	args.sampleTime = APP->engine->getSampleTime();
+
+	// Warm-up
+	int64_t warmup = std::min(frames / 10, (int64_t)args.sampleRate);
+	for (int64_t f = 0; f < warmup; f++) {
+		if (bc.step) bc.step(m, f);
+		driveInputs(m, bc.channels, f);
+		args.frame = f;
+		m->process(args);
+	}
+
+	// Overhead of the benchmark loop itself, including the generation of MIDI messages which are
+	// not delivered to the module while no port is subscribed to the device
+	std::set<midi::Input*> subscribed;
+	std::swap(subscribed, midiDriver->device.subscribed);
+	auto t0 = std::chrono::steady_clock::now();
+	uint64_t c0 = readCycles();
+	for (int64_t f = warmup; f < warmup + frames; f++) {
+		if (bc.step) bc.step(m, f);
+		driveInputs(m, bc.channels, f);
+		args.frame = f;
+	}
+	uint64_t c1 = readCycles();
+	auto t1 = std::chrono::steady_clock::now();
+	std::swap(subscribed, midiDriver->device.subscribed);
+
+	for (int64_t f = warmup; f < warmup + frames; f++) {
+		if (bc.step) bc.step(m, f);
+		driveInputs(m, bc.channels, f);
+		args.frame = f;
+		m->process(args);
+	}
+	uint64_t c2 = readCycles();
+	auto t2 = std::chrono::steady_clock::now();
+
+	double nsOverhead = std::chrono::duration<double, std::nano>(t1 - t0).count();
+	double ns = std::chrono::duration<double, std::nano>(t2 - t1).count();
+	BenchResult r;
+	r.nsPerSample = std::max(0.0, ns - nsOverhead) / frames;
+	r.cyclesPerSample = std::max(0.0, double(c2 - c1) - double(c1 - c0)) / frames;
+
+	env.clear();
+	return r;
+}
+
+
+static int run(int argc, char* argv[]) {
+	int64_t frames = 1000000;
+	std::string filter;
+	bool csv = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-f" && i + 1 < argc) {
+			frames = int64_t(std::atof(argv[++i]) * 1000000);
+		}
+		else if (arg == "-m" && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else if (arg == "-csv") {
+			csv = true;
+		}
+		else {
+			std::fprintf(stderr, "Usage: %s [-f <million frames>] [-m <model slug>] [-csv]\n", argv[0]);
+			return 1;
+		}
+	}
+	frames = std::max(frames, (int64_t)1);
+
+	// Headless Rack context
+	settings::devMode = true;
+	logger::init();
+	random::init();
+	asset::userDir = system::getTempDirectory();
+	contextSet(new Context);
+	APP->engine = new engine::Engine;
+
+	midiDriver = new BenchMidiDriver;
+	midi::addDriver(BENCH_MIDI_DRIVER_ID, midiDriver);
+
+	Plugin* p = new Plugin;
+	p->slug = "Stoermelder-P1";
+	init(p);
+
+	for (int i = 0; i < SIGNAL_LENGTH; i++) {
+		float ph = float(i) / SIGNAL_LENGTH;
+		testSignal[i] = 5.f * std::sin(2.f * M_PI * ph * 7.f) + 2.f * std::sin(2.f * M_PI * ph * 113.f) + random::normal() * 0.1f;
+	}
+
+	if (csv) {
+		std::printf("model,channels,ns/sample,cycles/sample\n");
+	}
+	else {
+		std::printf("%-24s %8s %12s %14s\n", "model", "channels", "ns/sample", "cycles/sample");
+	}
+
+	for (const BenchCase& bc : benchCases()) {
+		if (!filter.empty() && filter != bc.modelSlug) continue;
+		BenchResult r = runCase(bc, frames);
+		std::string name = bc.variant.empty() ? bc.modelSlug : bc.modelSlug + " (" + bc.variant + ")";
+		if (csv) {
+			std::printf("%s,%i,%.2f,%.1f\n", name.c_str(), bc.channels, r.nsPerSample, r.cyclesPerSample);
+		}
+		else {
+			std::printf("%-24s %8i %12.2f %14.1f\n", name.c_str(), bc.channels, r.nsPerSample, r.cyclesPerSample);
+		}
+		std::fflush(stdout);
+	}
+
+	logger::destroy();
+	return 0;
+}
+
+} // namespace Bench
+} // namespace StoermelderPackOne
+
+
+int main(int argc, char* argv[]) {
+	return StoermelderPackOne::Bench::run(argc, argv);
+}
@@ -34,6 +34,11 @@ enum SEQINTERPOLATE {
 	CUBIC = 1
 };
 
+enum SEQPHMODE {
+	PHASE = 0,
+	LFO = 1
+};
+
 enum SEQPRESET {
 	CIRCLE,
 	SPIRAL,
@@ -56,6 +61,75 @@ struct SeqItem {
 	float x[SEQ_LENGTH];
 	float y[SEQ_LENGTH];
 	int length = 0;
+	/** Must be incremented on every change of the points, see SeqTable */
+	int version = 0;
+
+	void changed() {
+		version++;
+	}
+};
+
+/** Polynomial coefficients of all segments of a SeqItem, so playback is a constant-time lookup */
+struct SeqTable {
+	/** Segment i is a[i] * mu^3 + b[i] * mu^2 + c[i] * mu + d[i] with mu in [0, 1) */
+	Vec a[SEQ_LENGTH];
+	Vec b[SEQ_LENGTH];
+	Vec c[SEQ_LENGTH];
+	Vec d[SEQ_LENGTH];
+	int length = 0;
+
+	/** SeqItem and its state the table has been compiled from */
+	const SeqItem* item = NULL;
+	int version = -1;
+	SEQINTERPOLATE interpolate = SEQINTERPOLATE::LINEAR;
+
+	bool valid(const SeqItem* s, SEQINTERPOLATE interpolate) {
+		return item == s && version == s->version && this->interpolate == interpolate;
+	}
+
+	void compile(const SeqItem* s, SEQINTERPOLATE interpolate) {
+		item = s;
+		version = s->version;
+		this->interpolate = interpolate;
+		length = s->length;
+		int l = length - 1;
+		for (int i = 0; i < length; i++) {
+			int i0 = i;
+			int i1 = i;
+			int i2 = std::min(i + 1, l);
+			int i3 = std::min(i + 2, l);
+			switch (interpolate) {
+				case SEQINTERPOLATE::LINEAR: {
+					a[i] = b[i] = Vec(0.f, 0.f);
+					c[i] = Vec(s->x[i2] - s->x[i1], s->y[i2] - s->y[i1]);
+					d[i] = Vec(s->x[i1], s->y[i1]);
+					break;
+				}
+				case SEQINTERPOLATE::CUBIC: {
+					a[i].x = -0.5f * s->x[i0] + 1.5f * s->x[i1] - 1.5f * s->x[i2] + 0.5f * s->x[i3];
+					a[i].y = -0.5f * s->y[i0] + 1.5f * s->y[i1] - 1.5f * s->y[i2] + 0.5f * s->y[i3];
+					b[i].x = s->x[i0] - 2.5f * s->x[i1] + 2.f * s->x[i2] - 0.5f * s->x[i3];
+					b[i].y = s->y[i0] - 2.5f * s->y[i1] + 2.f * s->y[i2] - 0.5f * s->y[i3];
+					c[i].x = -0.5f * s->x[i0] + 0.5f * s->x[i2];
+					c[i].y = -0.5f * s->y[i0] + 0.5f * s->y[i2];
+					d[i] = Vec(s->x[i1], s->y[i1]);
+					break;
+				}
+			}
+		}
+	}
+
+	/** pos must be in [0, 1] */
+	Vec value(float pos) {
+		if (length == 0) return Vec(0.5f, 0.5f);
+		float intf;
+		float mu = std::modf((length - 1) * pos, &intf);
+		int i = int(intf);
+		float mu2 = mu * mu;
+		float x = a[i].x * mu * mu2 + b[i].x * mu2 + c[i].x * mu + d[i].x;
+		float y = a[i].y * mu * mu2 + b[i].y * mu2 + c[i].y * mu + d[i].y;
+		return Vec(x, y);
+	}
 };
 
 
@@ -125,10 +199,14 @@ struct ArenaModule : Module {
 	bool inputYBipolar[IN_PORTS];
 	/** [Stored to JSON] */
 	OUTPUTMODE outputMode[IN_PORTS];
+	/** [Stored to JSON] every channel of the in-port is placed as separate voice */
+	bool inputPoly[IN_PORTS];
 	/** [Stored to JSON] */
 	bool mixportXBipolar[MIX_PORTS];
 	/** [Stored to JSON] */
 	bool mixportYBipolar[MIX_PORTS];
+	/** [Stored to JSON] voices of polyphonic in-ports are output on separate channels */
+	bool mixportPoly[MIX_PORTS];
 	/** [Stored to JSON] */
 	int inportsUsed = IN_PORTS;
 	/** [Stored to JSON] */
@@ -142,19 +220,42 @@ struct ArenaModule : Module {
 	SEQINTERPOLATE seqInterpolate[MIX_PORTS];
 	/** [Stored to JSON] */
 	int seqSelected[MIX_PORTS];
+	/** [Stored to JSON] usage of the PHASE-port */
+	SEQPHMODE seqPhMode[MIX_PORTS];
+	float seqPhase[MIX_PORTS];
+	/** Compiled sequences for playback by the PHASE-port, owned by the engine's thread */
+	SeqTable seqTable[MIX_PORTS];
 	int seqEdit;
 
 	int seqCopyPort = -1;
 	int seqCopySeq = -1;
 
-	float dist[MIX_PORTS][IN_PORTS];
+	/** Number of in-ports rounded up to full float_4 lanes */
+	static const int IN_LANES = (IN_PORTS + 3) / 4 * 4;
+
+	alignas(16) float dist[MIX_PORTS][IN_LANES];
+	/** Gain of every in-port on every mix-port, recomputed only if a position or radius has changed */
+	alignas(16) float gain[MIX_PORTS][IN_LANES];
 	float offsetX[IN_PORTS];
 	float offsetY[IN_PORTS];
 
-	//float lastInXpos[IN_PORTS];
-	//float lastInYpos[IN_PORTS];
-	//float lastMixXpos[MIX_PORTS];
-	//float lastMixYpos[MIX_PORTS];
+	/** State of the in-ports the gains have been computed for, zero on unused or unconnected in-ports */
+	alignas(16) float lastInXpos[IN_LANES] = {};
+	alignas(16) float lastInYpos[IN_LANES] = {};
+	alignas(16) float lastInRadius[IN_LANES] = {};
+	alignas(16) float lastInActive[IN_LANES] = {};
+	float lastMixXpos[MIX_PORTS];
+	float lastMixYpos[MIX_PORTS];
+
+	/** Number of voices of polyphonic in-ports, zero if the in-port is not polyphonic or not connected */
+	int voiceChannels[IN_PORTS] = {};
+	float voiceRadius[IN_PORTS];
+	bool voiceChanged[IN_PORTS];
+	alignas(16) float voiceXpos[IN_PORTS][PORT_MAX_CHANNELS];
+	alignas(16) float voiceYpos[IN_PORTS][PORT_MAX_CHANNELS];
+	/** Signal of the voices, zero on unused channels */
+	alignas(16) float voiceIn[IN_PORTS][PORT_MAX_CHANNELS];
+	alignas(16) float voiceGain[MIX_PORTS][IN_PORTS][PORT_MAX_CHANNELS];
 
 	dsp::SchmittTrigger seqTrigger[MIX_PORTS];
 	dsp::ClockDivider lightDivider;
@@ -189,6 +290,9 @@ struct ArenaModule : Module {
 			configParam(MIX_X_PARAM + i, -1.f, 1.f, 0.f, string::f("Channel MIX-%i x-pos attenuverter", i + 1), "x");
 			configParam(MIX_Y_PARAM + i, -1.f, 1.f, 0.f, string::f("Channel MIX-%i y-pos attenuverter", i + 1), "x");
 		}
+		for (int i = 0; i < MIX_PORTS; i++) {
+			lastMixXpos[i] = lastMixYpos[i] = -1.f;
+		}
 		onReset();
 		lightDivider.setDivision(512);
 	}
@@ -203,13 +307,17 @@ struct ArenaModule : Module {
 			inputXBipolar[i] = false;
 			inputYBipolar[i] = false;
 			outputMode[i] = OUTPUTMODE::SCALE;
+			inputPoly[i] = false;
 		}
 		for (int i = 0; i < MIX_PORTS; i++) {
 			mixportXBipolar[i] = false;
 			mixportYBipolar[i] = false;
+			mixportPoly[i] = false;
 			seqSelected[i] = 0;
 			seqMode[i] = SEQMODE::TRIG_FWD;
 			seqInterpolate[i] = SEQINTERPOLATE::LINEAR;
+			seqPhMode[i] = SEQPHMODE::PHASE;
+			seqPhase[i] = 0.f;
 		}
 		seqCopyPort = -1;
 		seqCopySeq = -1;
@@ -288,17 +396,68 @@ struct ArenaModule : Module {
 				sd *= amount[j];
 				inNorm[j] = sd;
 			}
+
+			if (inputPoly[j] && inputs[IN + j].isConnected()) {
+				voicesProcess(j);
+			}
+			else {
+				voiceChannels[j] = 0;
+			}
 		}
 
-		float outNorm[IN_PORTS] = {0.f};
+		// Check if any in-port has been moved since the gains have been computed
+		bool inChanged = false;
+		for (int j = 0; j < IN_LANES; j++) {
+			bool used = j < inportsUsed;
+			// Polyphonic in-ports are mixed by their voices' gains
+			float active = used && inputs[IN + j].isConnected() && !inputPoly[j];
+			float x = used ? params[IN_X_POS + j].getValue() : 0.f;
+			float y = used ? params[IN_Y_POS + j].getValue() : 0.f;
+			float r = used ? radius[j] : 0.f;
+			if (x != lastInXpos[j] || y != lastInYpos[j] || r != lastInRadius[j] || active != lastInActive[j]) {
+				lastInXpos[j] = x;
+				lastInYpos[j] = y;
+				lastInRadius[j] = r;
+				lastInActive[j] = active;
+				inChanged = true;
+			}
+		}
+
+		alignas(16) float inNormLanes[IN_LANES] = {};
+		std::copy(inNorm, inNorm + IN_PORTS, inNormLanes);
+		simd::float_4 outNorm4[IN_LANES / 4];
+		for (int j = 0; j < IN_LANES / 4; j++) {
+			outNorm4[j] = 0.f;
+		}
+		simd::float_4 voiceNorm4[IN_PORTS][PORT_MAX_CHANNELS / 4];
+		for (int j = 0; j < inportsUsed; j++) {
+			for (int c = 0; c < voiceChannels[j]; c += 4) {
+				voiceNorm4[j][c / 4] = 0.f;
+			}
+		}
 		for (int i = 0; i < mixportsUsed; i++) {
 			if (inputs[SEQ_INPUT + i].isConnected()) {
 				seqProcess(i);
 			}
 
 			if (inputs[SEQ_PH_INPUT + i].isConnected()) {
-				float v = clamp(inputs[SEQ_PH_INPUT + i].getVoltage() / 10.f, 0.f, 1.f);
-				Vec d = seqValue(i, v);
+				float v;
+				switch (seqPhMode[i]) {
+					default:
+					case SEQPHMODE::PHASE: {
+						v = clamp(inputs[SEQ_PH_INPUT + i].getVoltage() / 10.f, 0.f, 1.f);
+						break;
+					}
+					case SEQPHMODE::LFO: {
+						// 0V = 1Hz, 1V/oct, reaches audio rates
+						float f = dsp::approxExp2_taylor5(clamp(inputs[SEQ_PH_INPUT + i].getVoltage(), -10.f, 12.f));
+						seqPhase[i] += f * args.sampleTime;
+						seqPhase[i] -= std::floor(seqPhase[i]);
+						v = seqPhase[i];
+						break;
+					}
+				}
+				Vec d = seqPlay(i, v);
 				params[MIX_X_POS + i].setValue(d.x);
 				params[MIX_Y_POS + i].setValue(d.y);
 			}
@@ -321,77 +480,87 @@ struct ArenaModule : Module {
 
 			float mixX = params[MIX_X_POS + i].getValue();
 			float mixY = params[MIX_Y_POS + i].getValue();
-			Vec mixVec = Vec(mixX, mixY);
+			bool mixChanged = mixX != lastMixXpos[i] || mixY != lastMixYpos[i];
+			if (inChanged || mixChanged) {
+				lastMixXpos[i] = mixX;
+				lastMixYpos[i] = mixY;
+				gainUpdate(i, mixX, mixY);
+			}
 
-			float mix = 0.f;
+			simd::float_4 mix4 = 0.f;
+			for (int j = 0; j < IN_LANES; j += 4) {
+				simd::float_4 s = simd::float_4::load(&gain[i][j]);
+				outNorm4[j / 4] += s;
+				mix4 += s * simd::float_4::load(&inNormLanes[j]);
+			}
+
+			float mix = mix4[0] + mix4[1] + mix4[2] + mix4[3];
+
+			// Voices of polyphonic in-ports
+			int channels = 1;
+			simd::float_4 mixVoices4[PORT_MAX_CHANNELS / 4];
+			for (int c = 0; c < PORT_MAX_CHANNELS / 4; c++) {
+				mixVoices4[c] = 0.f;
+			}
 			for (int j = 0; j < inportsUsed; j++) {
-				float inX = params[IN_X_POS + j].getValue();
-				float inY = params[IN_Y_POS + j].getValue();
-
-				//if (mixX != lastMixXpos[i] || mixY != lastMixYpos[i] || inX != lastInXpos[j] || inY != lastInYpos[j]) {
-					//lastInXpos[j] = inX;
-					//lastInYpos[j] = inY;
-					Vec inVec = Vec(inX, inY);
-					dist[i][j] = inVec.minus(mixVec).norm();
-				//}
-
-				float r = radius[j];
-				if (inputs[IN + j].isConnected() && dist[i][j] < r) {
-					float s = std::min(1.0f, (r - dist[i][j]) / r * 1.1f);
-					outNorm[j] += s;
-					s *= inNorm[j];
-					mix += s;
+				int n = voiceChannels[j];
+				if (n == 0) continue;
+				if (voiceChanged[j] || mixChanged) {
+					voicesGainUpdate(i, j, mixX, mixY);
+				}
+				for (int c = 0; c < n; c += 4) {
+					simd::float_4 s = simd::float_4::load(&voiceGain[i][j][c]);
+					voiceNorm4[j][c / 4] += s;
+					mixVoices4[c / 4] += s * simd::float_4::load(&voiceIn[j][c]);
+				}
+				channels = std::max(channels, n);
+			}
+
+			float vol = params[MIX_VOL_PARAM + i].getValue();
+			Output& out = outputs[MIX_OUTPUT + i];
+			if (mixportPoly[i]) {
+				// Monophonic in-ports are mixed into all channels
+				out.setChannels(channels);
+				for (int c = 0; c < channels; c += 4) {
+					out.setVoltageSimd((mixVoices4[c / 4] + mix) * vol, c);
+				}
+			}
+			else {
+				for (int c = 0; c < channels; c += 4) {
+					simd::float_4 m = mixVoices4[c / 4];
+					mix += m[0] + m[1] + m[2] + m[3];
 				}
+				out.setChannels(1);
+				out.setVoltage(mix * vol);
 			}
+		}
+		// Gains of unused mix-ports get stale, recompute them when the mix-port is used again
+		for (int i = mixportsUsed; i < MIX_PORTS; i++) {
+			lastMixXpos[i] = -1.f;
+		}
 
-			//lastMixXpos[i] = mixX;
-			//lastMixYpos[i] = mixY;
-			mix *= params[MIX_VOL_PARAM + i].getValue();
-			outputs[MIX_OUTPUT + i].setVoltage(mix);
+		alignas(16) float outNorm[IN_LANES];
+		for (int j = 0; j < IN_LANES; j += 4) {
+			outNorm4[j / 4].store(&outNorm[j]);
 		}
 
 		for (int j = 0; j < inportsUsed; j++) {
 			if (inputs[IN + j].isConnected() && outputs[OUT_OUTPUT + j].isConnected()) {
-				float v = inputs[IN + j].getVoltage();
-				switch (outputMode[j]) {
-					case OUTPUTMODE::SCALE: {
-						v *= outNorm[j] / MIX_PORTS;
-						v = clamp(v, -10.f, 10.f);
-						break;
-					}
-					case OUTPUTMODE::LIMIT: {
-						v *= std::min(outNorm[j], 1.f);
-						v = clamp(v, -10.f, 10.f);
-						break;
-					}
-					case OUTPUTMODE::CLIP_UNI: {
-						v *= outNorm[j];
-						v = clamp(v, 0.f, 10.f);
-						break;
+				int n = voiceChannels[j];
+				if (n == 0) {
+					outputs[OUT_OUTPUT + j].setChannels(1);
+					outputs[OUT_OUTPUT + j].setVoltage(outputProcess(j, inputs[IN + j].getVoltage(), outNorm[j]));
+				}
+				else {
+					alignas(16) float voiceNorm[PORT_MAX_CHANNELS];
+					for (int c = 0; c < n; c += 4) {
+						voiceNorm4[j][c / 4].store(&voiceNorm[c]);
 					}
-					case OUTPUTMODE::CLIP_BI: {
-						v *= outNorm[j];
-						v = clamp(v, -5.f, 5.f);
-						break;
-					}
-					case OUTPUTMODE::FOLD_UNI: {
-						v = clamp(v, 0.f, 10.f) / 10.f * outNorm[j];
-						float intf;
-						float frac = std::modf(v, &intf);
-						v = int(intf) % 2 == 0 ? frac : (1.f - frac);
-						v *= 10.f;
-						break;
-					}
-					case OUTPUTMODE::FOLD_BI: {
-						v = clamp(v, -5.f, 5.f) / 5.f * outNorm[j];
-						float intf;
-						float frac = std::modf(v, &intf);
-						v = int(intf) % 2 == 0 ? frac : (frac >= 0.f ? (1.f - frac) : (-1.f - frac));
-						v *= 5.f;
-						break;
+					outputs[OUT_OUTPUT + j].setChannels(n);
+					for (int c = 0; c < n; c++) {
+						outputs[OUT_OUTPUT + j].setVoltage(outputProcess(j, inputs[IN + j].getVoltage(c), voiceNorm[c]), c);
 					}
 				}
-				outputs[OUT_OUTPUT + j].setVoltage(v);
 			}
 		}
 
@@ -406,6 +575,118 @@ struct ArenaModule : Module {
 		}
 	}
 
+	inline float outputProcess(int j, float v, float norm) {
+		switch (outputMode[j]) {
+			case OUTPUTMODE::SCALE: {
+				v *= norm / MIX_PORTS;
+				v = clamp(v, -10.f, 10.f);
+				break;
+			}
+			case OUTPUTMODE::LIMIT: {
+				v *= std::min(norm, 1.f);
+				v = clamp(v, -10.f, 10.f);
+				break;
+			}
+			case OUTPUTMODE::CLIP_UNI: {
+				v *= norm;
+				v = clamp(v, 0.f, 10.f);
+				break;
+			}
+			case OUTPUTMODE::CLIP_BI: {
+				v *= norm;
+				v = clamp(v, -5.f, 5.f);
+				break;
+			}
+			case OUTPUTMODE::FOLD_UNI: {
+				v = clamp(v, 0.f, 10.f) / 10.f * norm;
+				float intf;
+				float frac = std::modf(v, &intf);
+				v = int(intf) % 2 == 0 ? frac : (1.f - frac);
+				v *= 10.f;
+				break;
+			}
+			case OUTPUTMODE::FOLD_BI: {
+				v = clamp(v, -5.f, 5.f) / 5.f * norm;
+				float intf;
+				float frac = std::modf(v, &intf);
+				v = int(intf) % 2 == 0 ? frac : (frac >= 0.f ? (1.f - frac) : (-1.f - frac));
+				v *= 5.f;
+				break;
+			}
+		}
+		return v;
+	}
+
+	/**
+	 * Updates positions and signals of the voices of polyphonic in-port j. Voice c is positioned by
+	 * channel c of the X- and Y-port, or on the in-port's position if the port is not connected.
+	 */
+	void voicesProcess(int j) {
+		int n = inputs[IN + j].getChannels();
+		bool changed = n != voiceChannels[j] || radius[j] != voiceRadius[j];
+		voiceChannels[j] = n;
+		voiceRadius[j] = radius[j];
+
+		float x = params[IN_X_POS + j].getValue();
+		float y = params[IN_Y_POS + j].getValue();
+		bool xConnected = inputs[IN_X_INPUT + j].isConnected();
+		bool yConnected = inputs[IN_Y_INPUT + j].isConnected();
+		for (int c = 0; c < n; c += 4) {
+			simd::float_4 x4 = x;
+			if (xConnected) {
+				simd::float_4 xd = inputs[IN_X_INPUT + j].getPolyVoltageSimd<simd::float_4>(c);
+				xd += inputXBipolar[j] ? 5.f : 0.f;
+				x4 = simd::clamp(xd / 10.f, 0.f, 1.f);
+				x4 *= params[IN_X_PARAM + j].getValue();
+				x4 = simd::clamp(x4 + offsetX[j], 0.f, 1.f);
+			}
+			simd::float_4 y4 = y;
+			if (yConnected) {
+				simd::float_4 yd = inputs[IN_Y_INPUT + j].getPolyVoltageSimd<simd::float_4>(c);
+				yd += inputYBipolar[j] ? 5.f : 0.f;
+				y4 = simd::clamp(yd / 10.f, 0.f, 1.f);
+				y4 *= params[IN_Y_PARAM + j].getValue();
+				y4 = simd::clamp(y4 + offsetY[j], 0.f, 1.f);
+			}
+			simd::float_4 moved = (x4 != simd::float_4::load(&voiceXpos[j][c])) | (y4 != simd::float_4::load(&voiceYpos[j][c]));
+			changed |= simd::movemask(moved) != 0;
+			x4.store(&voiceXpos[j][c]);
+			y4.store(&voiceYpos[j][c]);
+
+			simd::float_4 s4 = simd::clamp(inputs[IN + j].getVoltageSimd<simd::float_4>(c), -10.f, 10.f) * amount[j];
+			simd::float_4 used = simd::float_4(c, c + 1, c + 2, c + 3) < float(n);
+			simd::ifelse(used, s4, 0.f).store(&voiceIn[j][c]);
+		}
+		voiceChanged[j] = changed;
+	}
+
+	/** Computes the gains of all voices of polyphonic in-port j to mix-port i, four voices at a time */
+	void voicesGainUpdate(int i, int j, float mixX, float mixY) {
+		simd::float_4 r = voiceRadius[j];
+		for (int c = 0; c < voiceChannels[j]; c += 4) {
+			simd::float_4 dx = simd::float_4::load(&voiceXpos[j][c]) - mixX;
+			simd::float_4 dy = simd::float_4::load(&voiceYpos[j][c]) - mixY;
+			simd::float_4 d = simd::sqrt(dx * dx + dy * dy);
+			simd::float_4 s = simd::fmin(1.f, (r - d) / r * 1.1f);
+			simd::ifelse(d < r, s, 0.f).store(&voiceGain[i][j][c]);
+		}
+	}
+
+	/** Computes distance and gain of all in-ports to mix-port i, four in-ports at a time */
+	void gainUpdate(int i, float mixX, float mixY) {
+		for (int j = 0; j < IN_LANES; j += 4) {
+			simd::float_4 dx = simd::float_4::load(&lastInXpos[j]) - mixX;
+			simd::float_4 dy = simd::float_4::load(&lastInYpos[j]) - mixY;
+			simd::float_4 d = simd::sqrt(dx * dx + dy * dy);
+			d.store(&dist[i][j]);
+
+			simd::float_4 r = simd::float_4::load(&lastInRadius[j]);
+			simd::float_4 s = simd::fmin(1.f, (r - d) / r * 1.1f);
+			simd::float_4 m = (simd::float_4::load(&lastInActive[j]) > 0.f) & (d < r);
+			simd::ifelse(m, s, 0.f).store(&gain[i][j]);
+		}
+	}
+
 	inline float getOpInput(int j) {
 		float v = inputs[MOD_INPUT + j].isConnected() ? inputs[MOD_INPUT + j].getVoltage() : 10.f;
 		v += modBipolar[j] ? 5.f : 0.f;
@@ -436,6 +717,15 @@ struct ArenaModule : Module {
 
 	void seqClear(int port) {
 		seqData[port][seqSelected[port]].length = 0;
+		seqData[port][seqSelected[port]].changed();
+	}
+
+	/** Same as seqValue() using the compiled sequence, must be called from the engine's thread only */
+	Vec seqPlay(int port, float pos) {
+		SeqItem* s = &seqData[port][seqSelected[port]];
+		SeqTable* t = &seqTable[port];
+		if (!t->valid(s, seqInterpolate[port])) t->compile(s, seqInterpolate[port]);
+		return t->value(pos);
 	}
 
 	Vec seqValue(int port, float pos) {
@@ -574,6 +864,7 @@ struct ArenaModule : Module {
 			seqData[port][seqSelected[port]].y[c] = pY;
 		}
 		seqData[port][seqSelected[port]].length = l;
+		seqData[port][seqSelected[port]].changed();
 	}
 
 	void seqPreset(int port, SEQPRESET preset, float x, float y, int parameter) {
@@ -655,6 +946,7 @@ struct ArenaModule : Module {
 				break;
 			}
 		}
+		seqData[port][seqSelected[port]].changed();
 	}
 
 	void seqRotate(int port, float angle) {
@@ -666,18 +958,21 @@ struct ArenaModule : Module {
 			seqData[port][seqSelected[port]].x[i] = std::max(0.f, std::min(p.x, 1.f));
 			seqData[port][seqSelected[port]].y[i] = std::max(0.f, std::min(p.y, 1.f));
 		}
+		seqData[port][seqSelected[port]].changed();
 	}
 
 	void seqFlipHorizontally(int port) {
 		for (int i = 0; i < seqData[port][seqSelected[port]].length; i++) {
 			seqData[port][seqSelected[port]].y[i] = 1.f - seqData[port][seqSelected[port]].y[i];
 		}
+		seqData[port][seqSelected[port]].changed();
 	}
 
 	void seqFlipVertically(int port) {
 		for (int i = 0; i < seqData[port][seqSelected[port]].length; i++) {
 			seqData[port][seqSelected[port]].x[i] = 1.f - seqData[port][seqSelected[port]].x[i];
 		}
+		seqData[port][seqSelected[port]].changed();
 	}
 
 	void seqCopy(int port) {
@@ -693,6 +988,7 @@ struct ArenaModule : Module {
 				seqData[port][seqSelected[port]].y[i] = seqData[seqCopyPort][seqCopySeq].y[i];
 			}
 			seqData[port][seqSelected[port]].length = seqData[seqCopyPort][seqCopySeq].length;
+			seqData[port][seqSelected[port]].changed();
 		}
 	}
 
@@ -713,6 +1009,7 @@ struct ArenaModule : Module {
 			//lastMixYpos[i] = -1.f;
 			for (int j = 0; j < SEQ_COUNT; j++) {
 				seqData[i][j].length = 0;
+				seqData[i][j].changed();
 			}
 		}
 		seqEdit = -1;
@@ -756,6 +1053,7 @@ struct ArenaModule : Module {
 			json_object_set_new(inportJ, "inputXBipolar", json_boolean(inputXBipolar[i]));
 			json_object_set_new(inportJ, "inputYBipolar", json_boolean(inputYBipolar[i]));
 			json_object_set_new(inportJ, "outputMode", json_integer(outputMode[i]));
+			json_object_set_new(inportJ, "inputPoly", json_boolean(inputPoly[i]));
 			json_array_append_new(inportsJ, inportJ);
 		}
 		json_object_set_new(rootJ, "inports", inportsJ);
@@ -765,9 +1063,11 @@ struct ArenaModule : Module {
 			json_t* mixportJ = json_object();
 			json_object_set_new(mixportJ, "mixportXBipolar", json_boolean(mixportXBipolar[i]));
 			json_object_set_new(mixportJ, "mixportYBipolar", json_boolean(mixportYBipolar[i]));
+			json_object_set_new(mixportJ, "mixportPoly", json_boolean(mixportPoly[i]));
 			json_object_set_new(mixportJ, "seqSelected", json_integer(seqSelected[i]));
 			json_object_set_new(mixportJ, "seqMode", json_integer(seqMode[i]));
 			json_object_set_new(mixportJ, "seqInterpolate", json_integer(seqInterpolate[i]));
+			json_object_set_new(mixportJ, "seqPhMode", json_integer(seqPhMode[i]));
 			json_t* seqDataJ = json_array();
 			for (int j = 0; j < SEQ_COUNT; j++) {
 				SeqItem* s = &seqData[i][j];
@@ -807,6 +1107,7 @@ struct ArenaModule : Module {
 			inputXBipolar[inputIndex] = json_boolean_value(json_object_get(inportJ, "inputXBipolar"));
 			inputYBipolar[inputIndex] = json_boolean_value(json_object_get(inportJ, "inputYBipolar"));
 			outputMode[inputIndex] = (OUTPUTMODE)json_integer_value(json_object_get(inportJ, "outputMode"));
+			inputPoly[inputIndex] = json_boolean_value(json_object_get(inportJ, "inputPoly"));
 		}
 
 		json_t* mixportsJ = json_object_get(rootJ, "mixports");
@@ -815,9 +1116,11 @@ struct ArenaModule : Module {
 		json_array_foreach(mixportsJ, mixputIndex, mixportJ) {
 			mixportXBipolar[mixputIndex] = json_boolean_value(json_object_get(mixportJ, "mixportXBipolar"));
 			mixportYBipolar[mixputIndex] = json_boolean_value(json_object_get(mixportJ, "mixportYBipolar"));
+			mixportPoly[mixputIndex] = json_boolean_value(json_object_get(mixportJ, "mixportPoly"));
 			seqSelected[mixputIndex] = json_integer_value(json_object_get(mixportJ, "seqSelected"));
 			seqMode[mixputIndex] = (SEQMODE)json_integer_value(json_object_get(mixportJ, "seqMode"));
 			seqInterpolate[mixputIndex] = (SEQINTERPOLATE)json_integer_value(json_object_get(mixportJ, "seqInterpolate"));
+			seqPhMode[mixputIndex] = (SEQPHMODE)json_integer_value(json_object_get(mixportJ, "seqPhMode"));
 			json_t* seqDataJ = json_object_get(mixportJ, "seqData");
 			json_t* seqItemJ;
 			size_t seqItemIndex;
@@ -835,6 +1138,7 @@ struct ArenaModule : Module {
 					seqData[mixputIndex][seqItemIndex].y[yIndex] = json_real_value(yJ);
 				}
 				seqData[mixputIndex][seqItemIndex].length = yIndex;
+				seqData[mixputIndex][seqItemIndex].changed();
 			}
 		}
 
@@ -994,6 +1298,22 @@ struct OutputModeMenuItem : MenuItem {
 };
 
 
+template < typename MODULE >
+struct InputPolyItem : MenuItem {
+	MODULE* module;
+	int id;
+
+	void onAction(const event::Action& e) override {
+		module->inputPoly[id] ^= true;
+	}
+
+	void step() override {
+		rightText = module->inputPoly[id] ? "✔" : "";
+		MenuItem::step();
+	}
+};
+
+
 template < typename MODULE >
 struct RadiusChangeAction : history::ModuleAction {
 	int inputId;
@@ -1260,6 +1580,21 @@ struct MixportYMenuItem : MenuItem {
 	}
 };
 
+template < typename MODULE >
+struct MixportPolyItem : MenuItem {
+	MODULE* module;
+	int id;
+
+	void onAction(const event::Action& e) override {
+		module->mixportPoly[id] ^= true;
+	}
+
+	void step() override {
+		rightText = module->mixportPoly[id] ? "✔" : "";
+		MenuItem::step();
+	}
+};
+
 
 // Seq-Edit menu etc.
 
@@ -1334,6 +1669,38 @@ struct SeqModeMenuItem : MenuItem {
 };
 
 
+template < typename MODULE >
+struct SeqPhModeMenuItem : MenuItem {
+	SeqPhModeMenuItem() {
+		rightText = RIGHT_ARROW;
+	}
+
+	struct SeqPhModeItem : MenuItem {
+		MODULE* module;
+		int id;
+		SEQPHMODE seqPhMode;
+
+		void onAction(const event::Action& e) override {
+			module->seqPhMode[id] = seqPhMode;
+		}
+
+		void step() override {
+			rightText = module->seqPhMode[id] == seqPhMode ? "✔" : "";
+			MenuItem::step();
+		}
+	};
+
+	MODULE* module;
+	int id;
+	Menu* createChildMenu() override {
+		Menu* menu = new Menu;
+		menu->addChild(construct<SeqPhModeItem>(&MenuItem::text, "Phase 0..10V", &SeqPhModeItem::module, module, &SeqPhModeItem::id, id, &SeqPhModeItem::seqPhMode, SEQPHMODE::PHASE));
+		menu->addChild(construct<SeqPhModeItem>(&MenuItem::text, "LFO (V/Oct, 0V = 1Hz)", &SeqPhModeItem::module, module, &SeqPhModeItem::id, id, &SeqPhModeItem::seqPhMode, SEQPHMODE::LFO));
+		return menu;
+	}
+};
+
+
 template < typename MODULE >
 struct SeqInterpolateMenuItem : MenuItem {
 	SeqInterpolateMenuItem() {
@@ -1589,6 +1956,8 @@ struct ScreenInportDragWidget : ScreenDragWidget<MODULE> {
 		menu->addChild(construct<InputYMenuItem<MODULE>>(&MenuItem::text, "Y-port", &InputYMenuItem<MODULE>::module, AW::module, &InputYMenuItem<MODULE>::id, AW::id));
 		menu->addChild(construct<ModModeMenuItem<MODULE>>(&MenuItem::text, "MOD-port", &ModModeMenuItem<MODULE>::module, AW::module, &ModModeMenuItem<MODULE>::id, AW::id));
 		menu->addChild(construct<OutputModeMenuItem<MODULE>>(&MenuItem::text, "OUT-port", &OutputModeMenuItem<MODULE>::module, AW::module, &OutputModeMenuItem<MODULE>::id, AW::id));
+		menu->addChild(new MenuSeparator());
+		menu->addChild(construct<InputPolyItem<MODULE>>(&MenuItem::text, "Polyphonic voices", &InputPolyItem<MODULE>::module, AW::module, &InputPolyItem<MODULE>::id, AW::id));
 	}
 };
 
@@ -1673,6 +2042,9 @@ struct ScreenMixportDragWidget : ScreenDragWidget<MODULE> {
 		menu->addChild(construct<MixportXMenuItem<MODULE>>(&MenuItem::text, "X-port", &MixportXMenuItem<MODULE>::module, AW::module, &MixportXMenuItem<MODULE>::id, AW::id));
 		menu->addChild(construct<MixportYMenuItem<MODULE>>(&MenuItem::text, "Y-port", &MixportYMenuItem<MODULE>::module, AW::module, &MixportYMenuItem<MODULE>::id, AW::id));
 		menu->addChild(construct<SeqModeMenuItem<MODULE>>(&MenuItem::text, "SEQ-port", &SeqModeMenuItem<MODULE>::module, AW::module, &SeqModeMenuItem<MODULE>::id, AW::id));
+		menu->addChild(construct<SeqPhModeMenuItem<MODULE>>(&MenuItem::text, "PHASE-port", &SeqPhModeMenuItem<MODULE>::module, AW::module, &SeqPhModeMenuItem<MODULE>::id, AW::id));
+		menu->addChild(new MenuSeparator());
+		menu->addChild(construct<MixportPolyItem<MODULE>>(&MenuItem::text, "Polyphonic output", &MixportPolyItem<MODULE>::module, AW::module, &MixportPolyItem<MODULE>::id, AW::id));
 	}
 };
 
@@ -2041,6 +2413,8 @@ struct OpLedDisplay : StoermelderLedDisplay {
 		menu->addChild(construct<InputYMenuItem<MODULE>>(&MenuItem::text, "Y-port", &InputYMenuItem<MODULE>::module, module, &InputYMenuItem<MODULE>::id, id));
 		menu->addChild(construct<ModModeMenuItem<MODULE>>(&MenuItem::text, "MOD-port", &ModModeMenuItem<MODULE>::module, module, &ModModeMenuItem<MODULE>::id, id));
 		menu->addChild(construct<OutputModeMenuItem<MODULE>>(&MenuItem::text, "OUT-port", &OutputModeMenuItem<MODULE>::module, module, &OutputModeMenuItem<MODULE>::id, id));
+		menu->addChild(new MenuSeparator());
+		menu->addChild(construct<InputPolyItem<MODULE>>(&MenuItem::text, "Polyphonic voices", &InputPolyItem<MODULE>::module, module, &InputPolyItem<MODULE>::id, id));
 	}
 };
 
@@ -2088,6 +2462,7 @@ struct SeqChangeAction : history::ModuleAction {
 			m->seqData[portId][seqId].y[i] = oldSeqY[i];
 		}
 		m->seqData[portId][seqId].length = oldSeqLength;
+		m->seqData[portId][seqId].changed();
 	}
 
 	void redo() override {
@@ -2100,6 +2475,7 @@ struct SeqChangeAction : history::ModuleAction {
 			m->seqData[portId][seqId].y[i] = newSeqY[i];
 		}
 		m->seqData[portId][seqId].length = newSeqLength;
+		m->seqData[portId][seqId].changed();
 	}
 };
 
@@ -2334,6 +2710,7 @@ struct SeqEditDragWidget : OpaqueWidget {
 		h->name += " clear";
 
 		module->seqData[id][seq].length = 0;
+		module->seqData[id][seq].changed();
 
 		h->setNew(module);
 		APP->history->push(h);
@@ -2395,6 +2772,7 @@ struct SeqEditDragWidget : OpaqueWidget {
 		dragPos = APP->scene->rack->getMousePos().minus(box.pos);
 		timerClear = true;
 		module->seqData[id][seq].length = 0;
+		module->seqData[id][seq].changed();
 
 		// history
 		dragChange = new SeqChangeAction<MODULE>;
@@ -2426,6 +2804,7 @@ struct SeqEditDragWidget : OpaqueWidget {
 				module->seqData[id][seq].x[index] = x;
 				module->seqData[id][seq].y[index] = y;
 				module->seqData[id][seq].length = index + 1;
+				module->seqData[id][seq].changed();
 				index++;
 			}
 			timer = now;
@@ -2736,6 +3115,9 @@ struct SeqLedDisplay : StoermelderLedDisplay {
 		menu->addChild(construct<MixportXMenuItem<MODULE>>(&MenuItem::text, "X-port", &MixportXMenuItem<MODULE>::module, module, &MixportXMenuItem<MODULE>::id, id));
 		menu->addChild(construct<MixportYMenuItem<MODULE>>(&MenuItem::text, "Y-port", &MixportYMenuItem<MODULE>::module, module, &MixportYMenuItem<MODULE>::id, id));
 		menu->addChild(construct<SeqModeMenuItem<MODULE>>(&MenuItem::text, "SEQ-port", &SeqModeMenuItem<MODULE>::module, module, &SeqModeMenuItem<MODULE>::id, id));
+		menu->addChild(construct<SeqPhModeMenuItem<MODULE>>(&MenuItem::text, "PHASE-port", &SeqPhModeMenuItem<MODULE>::module, module, &SeqPhModeMenuItem<MODULE>::id, id));
+		menu->addChild(new MenuSeparator());
+		menu->addChild(construct<MixportPolyItem<MODULE>>(&MenuItem::text, "Polyphonic output", &MixportPolyItem<MODULE>::module, module, &MixportPolyItem<MODULE>::id, id));
 	}
 };
 
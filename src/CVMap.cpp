@@ -1,6 +1,7 @@
 #include "plugin.hpp"
 #include "MapModuleBase.hpp"
 #include "CVMap.hpp"
+#include "digital/ScaledMapParamBank.hpp"
 #include "ui/ParamWidgetContextExtender.hpp"
 #include <chrono>
 
@@ -9,6 +10,8 @@ namespace CVMap {
 
 static const int MAX_CHANNELS = 32;
 
+typedef ScaledMapParamBank<MAX_CHANNELS>::Channel MapParam;
+
 struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 	enum ParamIds {
 		NUM_PARAMS
@@ -48,7 +51,7 @@ struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 	dsp::ClockDivider processDivider;
 	dsp::ClockDivider lightDivider;
 
-	ScaledMapParam<float> mapParam[MAX_CHANNELS];
+	ScaledMapParamBank<MAX_CHANNELS> mapParam;
 
 	Module* expCtx = NULL;
 
@@ -85,31 +88,47 @@ struct CVMapModule : CVMapModuleBase<MAX_CHANNELS> {
 		}
 	}
 
-	void process(const ProcessArgs& args) override {
-		if (audioRate || processDivider.process()) {
-			float deltaTime = args.sampleTime * (audioRate ? 1.f : float(processDivider.getDivision()));
-
-			// Step channels
-			for (int i = 0; i < mapLen; i++) {
-				ParamQuantity* paramQuantity = getParamQuantity(i);
-				if (paramQuantity == NULL) continue;
-				mapParam[i].setParamQuantity(paramQuantity);
+	/**
+	 * Steps all channels at once, same as ScaledMapParam::setValue() followed by ScaledMapParam::process()
+	 * for every channel: The voltages are gathered by mapInput, scaling and slew are computed four
+	 * channels at a time by the ScaledMapParamBank.
+	 */
+	void processChannels(float deltaTime) {
+		// Input voltages of both ports, indexed by mapInput
+		float voltages[32];
+		int channels[2];
+		for (int k = 0; k < 2; k++) {
+			Input& in = inputs[POLY_INPUT1 + k];
+			channels[k] = in.getChannels();
+			for (int c = 0; c < 16; c += 4) {
+				in.getVoltageSimd<simd::float_4>(c).store(&voltages[k * 16 + c]);
+			}
+		}
 
-				Input in = mapInput[i] < 16 ? inputs[POLY_INPUT1] : inputs[POLY_INPUT2];
-				if (!in.isConnected()) continue;
-				int c = mapInput[i] % 16;
-				if (c >= in.getChannels()) continue;
+		bool active[MAX_CHANNELS];
+		float t[MAX_CHANNELS];
+		float offset = bipolarInput ? 5.f : 0.f;
+		int n = (mapLen + 3) & ~3;
+		for (int i = 0; i < n; i++) {
+			active[i] = false;
+			t[i] = 0.f;
+			if (i >= mapLen) continue;
+			ParamQuantity* paramQuantity = resolveParamQuantity(i);
+			if (paramQuantity == NULL) continue;
+			mapParam[i].setParamQuantity(paramQuantity);
+			if (mapInput[i] % 16 >= channels[mapInput[i] / 16]) continue;
+			active[i] = true;
+			t[i] = (voltages[mapInput[i]] + offset) / 10.f;
+		}
 
-				float t = in.getVoltage(c);
-				if (bipolarInput) t += 5.f;
-				t /= 10.f;
+		mapParam.process(mapLen, t, active, resolvedParams, deltaTime, lockParameterChanges);
+	}
 
-				// Set a new value for the mapped parameter
-				mapParam[i].setValue(t);
+	void process(const ProcessArgs& args) override {
+		if (audioRate || processDivider.process()) {
+			float deltaTime = args.sampleTime * (audioRate ? 1.f : float(processDivider.getDivision()));
 
-				// Apply value on the mapped parameter (respecting slew and scale)
-				mapParam[i].process(deltaTime, lockParameterChanges);
-			}
+			processChannels(deltaTime);
 		}
 
 		// Set channel lights infrequently
@@ -348,13 +367,13 @@ struct CVMapChoice : MapModuleChoice<MAX_CHANNELS, CVMapModule> {
 	void appendContextMenu(Menu* menu) override {
 		menu->addChild(new MenuSeparator);
 		menu->addChild(construct<InputChannelMenuItem>(&MenuItem::text, "Input channel", &InputChannelMenuItem::module, module, &InputChannelMenuItem::id, id));
-		menu->addChild(new MapSlewSlider<>(&module->mapParam[id]));
+		menu->addChild(new MapSlewSlider<MapParam>(&module->mapParam[id]));
 		menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Scaling"));
-		menu->addChild(construct<MapScalingInputLabel<>>(&MenuLabel::text, "Input", &MapScalingInputLabel<>::p, &module->mapParam[id]));
-		menu->addChild(construct<MapScalingOutputLabel<>>(&MenuLabel::text, "Parameter range", &MapScalingOutputLabel<>::p, &module->mapParam[id]));
-		menu->addChild(new MapMinSlider<>(&module->mapParam[id]));
-		menu->addChild(new MapMaxSlider<>(&module->mapParam[id]));
-		menu->addChild(construct<MapPresetMenuItem<>>(&MenuItem::text, "Presets", &MapPresetMenuItem<>::p, &module->mapParam[id]));
+		menu->addChild(construct<MapScalingInputLabel<MapParam>>(&MenuLabel::text, "Input", &MapScalingInputLabel<MapParam>::p, &module->mapParam[id]));
+		menu->addChild(construct<MapScalingOutputLabel<MapParam>>(&MenuLabel::text, "Parameter range", &MapScalingOutputLabel<MapParam>::p, &module->mapParam[id]));
+		menu->addChild(new MapMinSlider<MapParam>(&module->mapParam[id]));
+		menu->addChild(new MapMaxSlider<MapParam>(&module->mapParam[id]));
+		menu->addChild(construct<MapPresetMenuItem<MapParam>>(&MenuItem::text, "Presets", &MapPresetMenuItem<MapParam>::p, &module->mapParam[id]));
 	}
 
 	std::string getSlotPrefix() override {
@@ -462,12 +481,12 @@ struct CVMapWidget : ThemedModuleWidget<CVMapModule>, ParamWidgetContextExtender
 				std::string cvMapId = expCtx ? "on \"" + expCtx->getCVMapId() + "\"" : "";
 				std::list<Widget*> w;
 				w.push_back(construct<InputChannelMenuItem>(&MenuItem::text, string::f("Re-map %s", cvMapId.c_str()), &InputChannelMenuItem::module, module, &InputChannelMenuItem::id, id));
-				w.push_back(new MapSlewSlider<>(&module->mapParam[id]));
+				w.push_back(new MapSlewSlider<MapParam>(&module->mapParam[id]));
 				w.push_back(construct<MenuLabel>(&MenuLabel::text, "Scaling"));
-				w.push_back(construct<MapScalingInputLabel<>>(&MenuLabel::text, "Input", &MapScalingInputLabel<>::p, &module->mapParam[id]));
-				w.push_back(construct<MapScalingOutputLabel<>>(&MenuLabel::text, "Parameter range", &MapScalingOutputLabel<>::p, &module->mapParam[id]));
-				w.push_back(new MapMinSlider<>(&module->mapParam[id]));
-				w.push_back(new MapMaxSlider<>(&module->mapParam[id]));
+				w.push_back(construct<MapScalingInputLabel<MapParam>>(&MenuLabel::text, "Input", &MapScalingInputLabel<MapParam>::p, &module->mapParam[id]));
+				w.push_back(construct<MapScalingOutputLabel<MapParam>>(&MenuLabel::text, "Parameter range", &MapScalingOutputLabel<MapParam>::p, &module->mapParam[id]));
+				w.push_back(new MapMinSlider<MapParam>(&module->mapParam[id]));
+				w.push_back(new MapMaxSlider<MapParam>(&module->mapParam[id]));
 				w.push_back(construct<CenterModuleItem>(&MenuItem::text, "Go to mapping module", &CenterModuleItem::mw, this));
 				w.push_back(new CVMapEndItem);
 
@@ -68,7 +68,7 @@ struct CVMapMicroModule : CVMapModuleBase<1> {
 	void process(const ProcessArgs& args) override {
 		if (audioRate || processDivider.process()) {
 			if (inputs[INPUT].isConnected()) {
-				ParamQuantity* paramQuantity = getParamQuantity(0);
+				ParamQuantity* paramQuantity = resolveParamQuantity(0);
 				if (paramQuantity) {
 					// Set ParamQuantity
 					float v = inputs[INPUT].getVoltage();
@@ -67,7 +67,7 @@ struct CVPamModule : MapModuleBase<MAX_CHANNELS> {
 
 			// Step channels
 			for (int i = 0; i < mapLen; i++) {
-				ParamQuantity* paramQuantity = getParamQuantity(i);
+				ParamQuantity* paramQuantity = resolveParamQuantity(i);
 				if (!paramQuantity) continue;
 
 				if (i < 16)
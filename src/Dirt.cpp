@@ -1,91 +1,116 @@
 #include "plugin.hpp"
-#include <random>
+#include "digital.hpp"
 
 namespace StoermelderPackOne {
 namespace Dirt {
 
 struct WhiteNoiseGenerator {
-	std::mt19937 rng;
-	std::uniform_real_distribution<float> uniform;
-	float ratio;
-
-	WhiteNoiseGenerator() {
-		reset();
-	}
+	Xorshift128_4 rng[PORT_MAX_CHANNELS / 4];
+	alignas(16) float ratio[PORT_MAX_CHANNELS];
 
 	void reset() {
-		// Exponential distribution
-		ratio = -std::log(random::uniform()) * 0.004f;
-		// White noise generator
-		uniform = std::uniform_real_distribution<float>(-ratio, ratio);
-		rng.seed(std::random_device()());
+		for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
+			// Exponential distribution
+			ratio[i] = -std::log(random::uniform()) * 0.004f;
+		}
+		for (int i = 0; i < PORT_MAX_CHANNELS / 4; i++) {
+			rng[i].seed();
+		}
 	}
 
-	float process() {
-		return uniform(rng);
+	void process(float* in, int channels) {
+		for (int c = 0; c < channels; c += 4) {
+			// White noise in -ratio..ratio
+			simd::float_4 u = rng[c / 4].uniform() * 2.f - 1.f;
+			simd::float_4 v = simd::float_4::load(&in[c]) + u * simd::float_4::load(&ratio[c]);
+			v.store(&in[c]);
+		}
 	}
 };
 
 struct CrosstalkGenerator {
-	float ratio[PORT_MAX_CHANNELS];
+	alignas(16) float ratio[PORT_MAX_CHANNELS];
 
-	dsp::BiquadFilter eqLow[PORT_MAX_CHANNELS];
-	dsp::BiquadFilter eqHigh[PORT_MAX_CHANNELS];
+	dsp::TBiquadFilter<simd::float_4> eqLow[PORT_MAX_CHANNELS / 4];
+	dsp::TBiquadFilter<simd::float_4> eqHigh[PORT_MAX_CHANNELS / 4];
 
 	void reset() {
+		setSampleRate(APP->engine->getSampleRate());
 		for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
-			eqLow[i].setParameters(dsp::BiquadFilter::LOWSHELF, 400.f / APP->engine->getSampleRate(), 1.f, 15.f);
-			eqHigh[i].setParameters(dsp::BiquadFilter::HIGHSHELF, 8000.f / APP->engine->getSampleRate(), 1.f, 15.f);
-
 			// Exponential distribution
 			ratio[i] = -std::log(random::uniform()) * 0.005f;
 		}
 	}
 
+	void setSampleRate(float sampleRate) {
+		for (int i = 0; i < PORT_MAX_CHANNELS / 4; i++) {
+			eqLow[i].setParameters(dsp::TBiquadFilter<simd::float_4>::LOWSHELF, 400.f / sampleRate, 1.f, 15.f);
+			eqHigh[i].setParameters(dsp::TBiquadFilter<simd::float_4>::HIGHSHELF, 8000.f / sampleRate, 1.f, 15.f);
+		}
+	}
+
 	void process(float* in, int channels) {
-		float f[channels];
-		for (int i = 0; i < channels; i++) {
-			f[i] = 0.f;
+		// Filtered channels with one zero channel on each side
+		alignas(16) float f[PORT_MAX_CHANNELS + 8] = {};
+		for (int c = 0; c < channels; c += 4) {
+			simd::float_4 v = simd::float_4::load(&in[c]);
 			// Apply shelfing on low and high end
-			f[i] += eqLow[i].process(in[i]);
-			f[i] += eqHigh[i].process(in[i]);
+			(eqLow[c / 4].process(v) + eqHigh[c / 4].process(v)).store(&f[4 + c]);
+		}
+		for (int c = channels; c < PORT_MAX_CHANNELS; c++) {
+			f[4 + c] = 0.f;
 		}
 
-		for (int i = 0; i < channels; i++) {
-			if (i > 0) 
-				in[i] += f[i - 1] * ratio[i - 1];
-			if (i < channels - 1)
-				in[i] += f[i + 1] * ratio[i];
+		// Channel i receives f[i - 1] * ratio[i - 1] and f[i + 1] * ratio[i]
+		alignas(16) float r[PORT_MAX_CHANNELS + 4] = {};
+		std::copy(ratio, ratio + PORT_MAX_CHANNELS, r + 1);
+		for (int c = 0; c < channels; c += 4) {
+			simd::float_4 v = simd::float_4::load(&in[c]);
+			v += simd::float_4::load(&f[3 + c]) * simd::float_4::load(&r[c]);
+			v += simd::float_4::load(&f[5 + c]) * simd::float_4::load(&ratio[c]);
+			v.store(&in[c]);
 		}
 	}
 };
 
 struct CrackleGenerator {
-	std::mt19937 rng;
-	std::uniform_real_distribution<float> uniform;
-	float ratio[16];
+	Xorshift128_4 rng[PORT_MAX_CHANNELS / 4];
+	float ratio[PORT_MAX_CHANNELS];
+	/** exp(-ratio), |c| > ratio is equivalent to 1 - 2|u| < threshold */
+	alignas(16) float threshold[PORT_MAX_CHANNELS];
 
 	CrackleGenerator() {
 		reset();
 	}
 
 	void reset() {
-		for (int i = 0; i < 16; i++) {
+		for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
 			ratio[i] = 8.f + 5.5f * random::uniform();
 		}
+		ratioChanged();
+		for (int i = 0; i < PORT_MAX_CHANNELS / 4; i++) {
+			rng[i].seed();
+		}
+	}
 
-		uniform = std::uniform_real_distribution<float>(0.0f, 1.0f);
-		rng.seed(std::random_device()());
+	void ratioChanged() {
+		for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
+			threshold[i] = std::exp(-ratio[i]);
+		}
 	}
 
 	void process(float* in, int channels) {
-		for (int i = 0; i < channels; i++) {
+		for (int c = 0; c < channels; c += 4) {
 			// Laplace distribution
 			// https://en.wikipedia.org/wiki/Laplace_distribution
-			float u = uniform(rng) - 0.5f;
-			float c = sgn(u) * std::log(1 - 2 * abs(u));
-			// "Filter" out small values
-			in[i] += abs(c) > ratio[i] ? 0.025f * c : 0.f;
+			simd::float_4 u = rng[c / 4].uniform() - 0.5f;
+			simd::float_4 a = 1.f - 2.f * simd::abs(u);
+			// "Filter" out small values, the logarithm is needed only for the rare remaining ones
+			simd::float_4 b = a < simd::float_4::load(&threshold[c]);
+			if (simd::movemask(b) == 0) continue;
+			simd::float_4 l = simd::sgn(u) * simd::log(a);
+			simd::float_4 v = simd::float_4::load(&in[c]) + simd::ifelse(b, 0.025f * l, 0.f);
+			v.store(&in[c]);
 		}
 	}
 };
@@ -113,7 +138,7 @@ struct DirtModule : Module {
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 
-	WhiteNoiseGenerator noise[PORT_MAX_CHANNELS];
+	WhiteNoiseGenerator noise;
 	CrosstalkGenerator crosstalk;
 	CrackleGenerator crackle;
 
@@ -125,22 +150,22 @@ struct DirtModule : Module {
 		configSwitch(PARAM_CRACKE, 0.f, 1.f, 1.f, "Crackle per channel", {"Off", "On"});
 		configInput(INPUT, "Polyphonic");
 		configOutput(OUTPUT, "Polyphonic");
-		for (size_t i = 0; i < PORT_MAX_CHANNELS; i++) {
-			noise[i].reset();
- 		}
+		noise.reset();
 		crosstalk.reset();
 	}
 
+	void onSampleRateChange() override {
+		crosstalk.setSampleRate(APP->engine->getSampleRate());
+	}
+
 	void process(const ProcessArgs& args) override {
 		int channels = inputs[INPUT].getChannels();
 
-		float in[channels];
+		alignas(16) float in[PORT_MAX_CHANNELS] = {};
 		inputs[INPUT].readVoltages(in);
 
 		if (params[PARAM_NOISE].getValue() > 0.f) {
-			for (int i = 0; i < channels; i++) {
-				in[i] += noise[i].process();
-			}
+			noise.process(in, channels);
 		}
 
 		if (params[PARAM_CROSSTALK].getValue() > 0.f) {
@@ -162,7 +187,7 @@ struct DirtModule : Module {
 		json_t* channelsJ = json_array();
 		for (int i = 0; i < PORT_MAX_CHANNELS; i++) {
 			json_t* channelJ = json_object();
-			json_object_set_new(channelJ, "noiseRatio", json_real(noise[i].ratio));
+			json_object_set_new(channelJ, "noiseRatio", json_real(noise.ratio[i]));
 			json_object_set_new(channelJ, "crosstalkRatio", json_real(crosstalk.ratio[i]));
 			json_object_set_new(channelJ, "crackleRatio", json_real(crackle.ratio[i]));
 			json_array_append_new(channelsJ, channelJ);
@@ -175,14 +200,16 @@ struct DirtModule : Module {
 	void dataFromJson(json_t* rootJ) override {
 		panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
 
-		json_t* channelsJ = json_object_get(rootJ, "presets");
+		json_t* channelsJ = json_object_get(rootJ, "channels");
 		json_t* channelJ;
 		size_t i;
 		json_array_foreach(channelsJ, i, channelJ) {
-			noise[i].ratio = json_real_value(json_object_get(channelJ, "noiseRatio"));
+			if (i >= PORT_MAX_CHANNELS) break;
+			noise.ratio[i] = json_real_value(json_object_get(channelJ, "noiseRatio"));
 			crosstalk.ratio[i] = json_real_value(json_object_get(channelJ, "crosstalkRatio"));
 			crackle.ratio[i] = json_real_value(json_object_get(channelJ, "crackleRatio"));
 		}
+		crackle.ratioChanged();
 	}
 };
 
@@ -126,6 +126,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 	/** [Stored to JSON] */
 	NVGcolor boxColor;
 
+	/** Holds a reference on the json_t* */
 	dsp::RingBuffer<std::tuple<ModuleWidget*, json_t*>, 16> workerGuiQueue;
 	TaskWorker taskWorker;
 
@@ -146,6 +147,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 			BASE::slot[i].lights = &Module::lights[LIGHT_PRESET + i * 3];
 			BASE::slot[i].presetSlotUsed = &BASE::presetSlotUsed[i];
 			BASE::slot[i].preset = &BASE::preset[i];
+			BASE::slot[i].plan = &BASE::plan[i];
 			BASE::slot[i].presetButton = &BASE::presetButton[i];
 		}
 
@@ -179,6 +181,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 			}
 			BASE::presetSlotUsed[i] = false;
 			BASE::textLabel[i] = "";
+			BASE::planInvalidate(i);
 		}
 		for (BoundModule* b : boundModules) {
 			delete b;
@@ -418,7 +421,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 						case LongPressButton::NO_PRESS:
 							break;
 						case LongPressButton::SHORT_PRESS:
-							presetSave(i);
+							presetSave(i, true);
 							break;
 						case LongPressButton::LONG_PRESS:
 							presetClear(i);
@@ -488,6 +491,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 				}
 			}
 			*(slot->presetSlotUsed) = slot->preset->size() > 0;
+			slot->planInvalidate();
 		}
 		for (auto it = std::begin(boundModules); it != std::end(boundModules); it++) {
 			if ((*it)->moduleId == b->moduleId) {
@@ -498,10 +502,11 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 		delete b;
 	}
 
-	void processWorker(int workerPreset) {
-		if (workerPreset < 0) return;
-
-		EightFaceMk2Slot* slot = expSlot(workerPreset);
+	/** Resolves the snapshot's JSON into parameter values, so loading needs no JSON parsing or lookups.
+	 * Allocates and locks the engine, must not be called from the engine's thread.
+	 */
+	std::shared_ptr<EightFaceMk2Plan> presetCompile(EightFaceMk2Slot* slot) {
+		std::shared_ptr<EightFaceMk2Plan> plan = std::make_shared<EightFaceMk2Plan>();
 		for (json_t* vJ : *slot->preset) {
 			json_t* idJ = json_object_get(vJ, "id");
 			if (!idJ) continue;
@@ -511,18 +516,88 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 			for (BoundModule* b : boundModules) {
 				if (b->moduleId != moduleId) continue;
 				if (b->pluginSlug != plugin || b->modelSlug != model) break;
-				ModuleWidget* mw = b->getModuleWidget();
-				if (!mw) continue;
 
-				if (b->needsGuiThread) {
-					workerGuiQueue.push(std::make_tuple(mw, vJ));
+				Module* m = APP->engine->getModule(moduleId);
+				json_t* paramsJ = json_object_get(vJ, "params");
+				// Modules needing the GUI-thread are applied by fromJson as a whole
+				if (!m || !paramsJ || b->needsGuiThread) {
+					plan->fallbacks.push_back({moduleId, json_incref(vJ), b->needsGuiThread});
+					break;
 				}
-				else {
-					mw->fromJson(vJ);
+				// Only data and bypass-state of other modules are left to fromJson
+				json_t* dataJ = json_object_get(vJ, "data");
+				json_t* bypassJ = json_object_get(vJ, "bypass");
+				if (dataJ || bypassJ) {
+					json_t* restJ = json_object();
+					if (dataJ) json_object_set(restJ, "data", dataJ);
+					if (bypassJ) json_object_set(restJ, "bypass", bypassJ);
+					plan->fallbacks.push_back({moduleId, restJ, false});
 				}
+
+				// Same as Module::paramsFromJson
+				EightFaceMk2Plan::Target t;
+				t.moduleId = moduleId;
+				t.model = m->model;
+				t.paramBegin = plan->paramIds.size();
+				json_t* paramJ;
+				size_t i;
+				json_array_foreach(paramsJ, i, paramJ) {
+					json_t* paramIdJ = json_object_get(paramJ, "id");
+					size_t paramId = paramIdJ ? json_integer_value(paramIdJ) : i;
+					if (paramId >= m->paramQuantities.size()) continue;
+					ParamQuantity* pq = m->paramQuantities[paramId];
+					if (!pq->isBounded()) continue;
+					json_t* valueJ = json_object_get(paramJ, "value");
+					if (!valueJ) continue;
+					float v = math::clampSafe((float)json_number_value(valueJ), pq->getMinValue(), pq->getMaxValue());
+					if (pq->snapEnabled) v = std::round(v);
+					plan->paramIds.push_back(paramId);
+					plan->values.push_back(v);
+				}
+				t.paramEnd = plan->paramIds.size();
+				plan->targets.push_back(t);
 				break;
 			}
 		}
+		plan->compiled = true;
+		return plan;
+	}
+
+	void processWorker(int workerPreset) {
+		if (workerPreset < 0) return;
+
+		EightFaceMk2Slot* slot = expSlot(workerPreset);
+		std::shared_ptr<EightFaceMk2Plan> plan = std::atomic_load(slot->plan);
+		if (!plan || !plan->compiled) {
+			std::shared_ptr<EightFaceMk2Plan> compiled = presetCompile(slot);
+			// The snapshot might have been saved or changed in the meantime, the compiled plan is
+			// stored only if it is still the latest one, otherwise the plan stored by now is used
+			if (std::atomic_compare_exchange_strong(slot->plan, &plan, compiled)) {
+				plan = compiled;
+			}
+			else if (!plan || !plan->compiled) {
+				plan = compiled;
+			}
+		}
+
+		for (const EightFaceMk2Plan::Target& t : plan->targets) {
+			Module* m = APP->engine->getModule(t.moduleId);
+			if (!m || m->model != t.model) continue;
+			for (size_t i = t.paramBegin; i < t.paramEnd; i++) {
+				APP->engine->setParamValue(m, plan->paramIds[i], plan->values[i]);
+			}
+		}
+
+		for (const EightFaceMk2Plan::Fallback& f : plan->fallbacks) {
+			ModuleWidget* mw = APP->scene->rack->getModule(f.moduleId);
+			if (!mw) continue;
+			if (f.needsGuiThread) {
+				workerGuiQueue.push(std::make_tuple(mw, json_incref(f.moduleJ)));
+			}
+			else {
+				mw->fromJson(f.moduleJ);
+			}
+		}
 	}
 
 	void processGui() {
@@ -531,6 +606,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 			ModuleWidget* mw = std::get<0>(t);
 			json_t* vJ = std::get<1>(t);
 			mw->fromJson(vJ);
+			json_decref(vJ);
 		}
 	}
 
@@ -553,7 +629,9 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 		}
 	}
 
-	void presetSave(int p) {
+	/** The snapshot is compiled right away unless called from the engine's thread, which leaves it
+	 * to the worker on the first load */
+	void presetSave(int p, bool engineThread = false) {
 		EightFaceMk2Slot* slot = expSlot(p);
 		if (*(slot->presetSlotUsed)) {
 			for (json_t* vJ : *(slot->preset)) {
@@ -569,6 +647,8 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 			json_t* vJ = mw->toJson();
 			slot->preset->push_back(vJ);
 		}
+		if (engineThread) slot->planInvalidate();
+		else std::atomic_store(slot->plan, presetCompile(slot));
 		preset = p;
 	}
 
@@ -582,6 +662,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 			*expSlotLabel(p) = "";
 		}
 		*(slot->presetSlotUsed) = false;
+		slot->planInvalidate();
 		if (preset == p) preset = -1;
 	}
 
@@ -618,6 +699,7 @@ struct EightFaceMk2Module : EightFaceMk2Base<NUM_PRESETS> {
 		for (json_t* vJ : *sourcePreset) {
 			targetPreset->push_back(json_deep_copy(vJ));
 		}
+		targetSlot->planInvalidate();
 		if (preset == target) preset = -1;
 	}
 
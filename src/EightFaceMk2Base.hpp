@@ -23,12 +23,52 @@ enum class CTRLMODE {
 	WRITE
 };
 
+/** Snapshot resolved into parameter values which can be written directly. Compiled once when the
+ * snapshot is saved or first loaded, only non-parameter data and modules needing the GUI-thread
+ * are applied using fromJson.
+ */
+struct EightFaceMk2Plan {
+	struct Target {
+		int64_t moduleId;
+		Model* model;
+		/** Range into paramIds and values */
+		size_t paramBegin;
+		size_t paramEnd;
+	};
+	struct Fallback {
+		int64_t moduleId;
+		/** Owned reference, holds only "data" and "bypass" unless the module needs the GUI-thread */
+		json_t* moduleJ;
+		bool needsGuiThread;
+	};
+
+	std::vector<Target> targets;
+	std::vector<int> paramIds;
+	std::vector<float> values;
+	std::vector<Fallback> fallbacks;
+	/** An empty plan which is not compiled marks a changed snapshot, each invalidation creates a
+	 * new instance so a compile of an outdated snapshot can be detected by comparing pointers */
+	bool compiled = false;
+
+	~EightFaceMk2Plan() {
+		for (Fallback& f : fallbacks) {
+			json_decref(f.moduleJ);
+		}
+	}
+};
+
 struct EightFaceMk2Slot {
 	Param* param;
 	Light* lights;
 	bool* presetSlotUsed;
 	std::vector<json_t*>* preset;
+	/** Access only using std::atomic_* functions, as the plan is used by the worker thread */
+	std::shared_ptr<EightFaceMk2Plan>* plan;
 	LongPressButton* presetButton;
+
+	void planInvalidate() {
+		std::atomic_store(plan, std::make_shared<EightFaceMk2Plan>());
+	}
 };
 
 template <int NUM_PRESETS>
@@ -42,6 +82,8 @@ struct EightFaceMk2Base : Module, StripIdFixModule {
 	std::vector<json_t*> preset[NUM_PRESETS];
 	/** [Stored to JSON] */
 	std::string textLabel[NUM_PRESETS];
+	/** Compiled form of preset, empty or not compiled if the snapshot has changed */
+	std::shared_ptr<EightFaceMk2Plan> plan[NUM_PRESETS];
 
 	LongPressButton presetButton[NUM_PRESETS];
 
@@ -56,6 +98,10 @@ struct EightFaceMk2Base : Module, StripIdFixModule {
 
 	virtual int faceSlotCmd(SLOT_CMD cmd, int i) { return -1; }
 
+	void planInvalidate(int i) {
+		std::atomic_store(&plan[i], std::make_shared<EightFaceMk2Plan>());
+	}
+
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
@@ -91,6 +137,7 @@ struct EightFaceMk2Base : Module, StripIdFixModule {
 			json_t* textLabelJ = json_object_get(presetJ, "textLabel");
 			if (textLabelJ) textLabel[presetIndex] = json_string_value(textLabelJ);
 			preset[presetIndex].clear();
+			planInvalidate(presetIndex);
 			if (presetSlotUsed[presetIndex]) {
 				json_t* slotJ = json_object_get(presetJ, "slot");
 				json_t* vJ;
@@ -39,6 +39,7 @@ struct EightFaceMk2ExModule : EightFaceMk2Base<NUM_PRESETS> {
 			BASE::slot[i].lights = &Module::lights[LIGHT_PRESET + i * 3];
 			BASE::slot[i].presetSlotUsed = &BASE::presetSlotUsed[i];
 			BASE::slot[i].preset = &BASE::preset[i];
+			BASE::slot[i].plan = &BASE::plan[i];
 			BASE::slot[i].presetButton = &BASE::presetButton[i];
 		}
 
@@ -66,6 +67,7 @@ struct EightFaceMk2ExModule : EightFaceMk2Base<NUM_PRESETS> {
 			BASE::presetSlotUsed[i] = false;
 			BASE::textLabel[i] = "";
 			BASE::preset[i].clear();
+			BASE::planInvalidate(i);
 			BASE::lights[LIGHT_PRESET + (i * 3) + 0].setBrightness(0.f);
 			BASE::lights[LIGHT_PRESET + (i * 3) + 1].setBrightness(0.f);
 			BASE::lights[LIGHT_PRESET + (i * 3) + 2].setBrightness(0.f);
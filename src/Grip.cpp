@@ -54,7 +54,7 @@ struct GripModule : CVMapModuleBase<MAX_CHANNELS> {
 		if (audioRate || processDivider.process()) {
 			// Step channels
 			for (int i = 0; i < mapLen; i++) {
-				ParamQuantity* paramQuantity = getParamQuantity(i);
+				ParamQuantity* paramQuantity = resolveParamQuantity(i);
 				if (paramQuantity == NULL) continue;
 
 				if (paramQuantity->getScaledValue() != lastValue[i]) {
@@ -14,7 +14,9 @@ enum SCENE_CV_MODE {
 	TRIG_FWD = 0,
 	VOLT = 8,
 	C4 = 9,
-	ARM = 7
+	ARM = 7,
+	MORPH_LINEAR = 10,
+	MORPH_EQUAL = 11
 };
 
 enum IN_MODE {
@@ -54,6 +56,11 @@ enum OUT_MODE {
 
 template < int PORTS >
 struct IntermixModule : Module, IntermixBase<PORTS> {
+	static_assert(PORTS % 4 == 0, "PORTS must be a multiple of 4");
+	/** Number of float_4 output-lanes accumulated at once by the dense kernel */
+	static const int BLOCK = PORTS / 4 < 4 ? PORTS / 4 : 4;
+	static_assert((PORTS / 4) % BLOCK == 0, "PORTS / 4 must be a multiple of BLOCK");
+
 	enum ParamIds {
 		ENUMS(PARAM_MATRIX, PORTS * PORTS),
 		ENUMS(PARAM_OUTPUT, PORTS),
@@ -77,7 +84,7 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 	enum LightIds {
 		ENUMS(LIGHT_MATRIX, PORTS * PORTS * 3),
 		ENUMS(LIGHT_OUTPUT, PORTS),
-		ENUMS(LIGHT_SCENE, PORTS),
+		ENUMS(LIGHT_SCENE, SCENE_MAX),
 		NUM_LIGHTS
 	};
 
@@ -90,6 +97,25 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 
 	alignas(16) float currentMatrix[PORTS][PORTS];
 
+	/** Non-zero entry of currentMatrix */
+	struct Crosspoint {
+		int input;
+		int output;
+		float gain;
+	};
+	/** Crosspoints mixed by the sparse kernel, sorted by input */
+	Crosspoint crosspoints[PORTS * PORTS];
+	int crosspointCount = 0;
+	/** Inputs mixed by the dense kernel: inputs in fade-mode and, if the matrix is dense, all inputs with crosspoints */
+	int denseInputs[PORTS];
+	int denseInputCount = 0;
+	/** Set whenever currentMatrix or the input-modes change */
+	bool crosspointsDirty = true;
+
+	/** currentMatrix and morphOutputAt are blended from two adjacent scenes by the SCENE-port */
+	bool sceneMorphing = false;
+	alignas(16) float morphOutputAt[PORTS];
+
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 
@@ -121,7 +147,8 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 	/** [Stored to JSON] */
 	int channelCount = 1;
 
-	LinearFade fader[PORTS][PORTS][PORT_MAX_CHANNELS];
+	/** Faders of all crosspoints, lanes are outputs. All channels share the same fades. */
+	LinearFade4 fader[PORTS][PORTS / 4];
 	uint32_t fadeInTs[PORTS];
 	uint32_t fadeOutTs[PORTS];
 	//dsp::TSlewLimiter<simd::float_4> outputAtSlew[PORTS / 4];
@@ -162,8 +189,10 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 		padBrightness = 0.75f;
 		inputVisualize = false;
 		outputClamp = true;
-		for (int i = 0; i < SCENE_MAX; i++) {
+		for (int i = 0; i < PORTS; i++) {
 			inputMode[i] = IM_DIRECT;
+		}
+		for (int i = 0; i < SCENE_MAX; i++) {
 			for (int j = 0; j < PORTS; j++) {
 				scenes[i].input[j] = IM_DIRECT;
 				scenes[i].output[j] = OM_OUT;
@@ -224,6 +253,11 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 					}
 					break;
 				}
+				case SCENE_CV_MODE::MORPH_LINEAR:
+				case SCENE_CV_MODE::MORPH_EQUAL: {
+					// Blended once per sceneDivider-block
+					break;
+				}
 			}
 		}
 
@@ -266,51 +300,95 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 				scenes[sceneSelected].outputAt[i] = params[PARAM_AT + i].getValue();
 				for (int j = 0; j < PORTS; j++) {
 					float p = params[PARAM_MATRIX + j * PORTS + i].getValue();
-					for (int c = 0; c < channelCount; c++) {
-						if (fadeIn) fader[i][j][c].setRise(f1);
-						if (fadeOut) fader[i][j][c].setFall(f2);
-						if (p != scenes[sceneSelected].matrix[i][j] && p == 1.f) fader[i][j][c].triggerFadeIn();
-						if (p != scenes[sceneSelected].matrix[i][j] && p == 0.f) fader[i][j][c].triggerFadeOut();
-					}
+					if (fadeIn) fader[i][j / 4].setRise(j % 4, f1);
+					if (fadeOut) fader[i][j / 4].setFall(j % 4, f2);
+					if (p != scenes[sceneSelected].matrix[i][j] && p == 1.f) fader[i][j / 4].triggerFadeIn(j % 4);
+					if (p != scenes[sceneSelected].matrix[i][j] && p == 0.f) fader[i][j / 4].triggerFadeOut(j % 4);
 					scenes[sceneSelected].matrix[i][j] = p;
 					IN_MODE mode = sceneInputMode ? scenes[sceneSelected].input[i] : inputMode[i];
 					if (mode != IN_MODE::IM_FADE) currentMatrix[i][j] = p;
 				}
 			}
+
+			sceneMorphing = inputs[INPUT_SCENE].isConnected() && (sceneMode == SCENE_CV_MODE::MORPH_LINEAR || sceneMode == SCENE_CV_MODE::MORPH_EQUAL);
+			if (sceneMorphing) {
+				sceneMorph(inputs[INPUT_SCENE].getVoltage());
+			}
+			crosspointsDirty = true;
+		}
+
+		if (crosspointsDirty) {
+			crosspointsUpdate();
+		}
+
+		// Faders advance once per sample for all channels, they are paused while morphing
+		for (int k = 0; k < denseInputCount && !sceneMorphing; k++) {
+			int i = denseInputs[k];
+			IN_MODE mode = sceneInputMode ? scenes[sceneSelected].input[i] : inputMode[i];
+			if (mode != IN_MODE::IM_FADE || !inputs[INPUT + i].isConnected()) continue;
+			for (int j = 0; j < PORTS / 4; j++) {
+				fader[i][j].process(args.sampleTime).store(&currentMatrix[i][j * 4]);
+			}
 		}
 
 		// DSP processing
 		for (int c = 0; c < channelCount; c++) {
 			simd::float_4 out[PORTS / 4] = {};
-			for (int i = 0; i < PORTS; i++) {
+			// Dense kernel
+			float in[PORTS];
+			const float* gain[PORTS];
+			int inCount = 0;
+			for (int k = 0; k < denseInputCount; k++) {
+				int i = denseInputs[k];
 				float v;
 				IN_MODE mode = sceneInputMode ? scenes[sceneSelected].input[i] : inputMode[i];
 				switch (mode) {
 					case IN_MODE::IM_OFF:
 						continue;
 					case IN_MODE::IM_DIRECT:
-						if (!inputs[INPUT + i].isConnected()) continue;
-						v = inputs[INPUT + i].getPolyVoltage(c);
-						break;
 					case IN_MODE::IM_FADE:
 						if (!inputs[INPUT + i].isConnected()) continue;
 						v = inputs[INPUT + i].getPolyVoltage(c);
-						for (int j = 0; j < PORTS; j++) {
-							currentMatrix[i][j] = fader[i][j][c].process(args.sampleTime);
-						}
 						break;
 					default:
 						v = (mode - 24) / 12.f;
 						break;
 				}
+				in[inCount] = v;
+				gain[inCount] = currentMatrix[i];
+				inCount++;
+			}
 
-				for (int j = 0; j < PORTS; j+=4) {
-					simd::float_4 v1 = simd::float_4::load(&currentMatrix[i][j]);
-					simd::float_4 v2 = v1 * simd::float_4(v);
-					out[j / 4] += v2;
+			// Blocks of BLOCK float_4 outputs are kept in registers while walking all inputs
+			for (int b = 0; b < PORTS / 4; b += BLOCK) {
+				for (int k = 0; k < inCount; k++) {
+					simd::float_4 v = in[k];
+					for (int j = 0; j < BLOCK; j++) {
+						out[b + j] += simd::float_4::load(&gain[k][(b + j) * 4]) * v;
+					}
 				}
 			}
 
+			// Sparse kernel
+			if (crosspointCount > 0) {
+				alignas(16) float outSparse[PORTS] = {};
+				int input = -1;
+				bool valid = false;
+				float v = 0.f;
+				for (int k = 0; k < crosspointCount; k++) {
+					const Crosspoint& cp = crosspoints[k];
+					if (cp.input != input) {
+						input = cp.input;
+						IN_MODE mode = sceneInputMode ? scenes[sceneSelected].input[input] : inputMode[input];
+						valid = mode != IN_MODE::IM_DIRECT || inputs[INPUT + input].isConnected();
+						v = mode == IN_MODE::IM_DIRECT ? inputs[INPUT + input].getPolyVoltage(c) : (mode - 24) / 12.f;
+					}
+					if (valid) outSparse[cp.output] += cp.gain * v;
+				}
+				for (int j = 0; j < PORTS; j+=4) {
+					out[j / 4] += simd::float_4::load(&outSparse[j]);
+				}
+			}
 
 			// -- Standard code --
 			/*
@@ -324,6 +402,7 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 
 			// -- SIMD code --
 			simd::float_4 oc = outputClamp;
+			const float* outputAt = sceneMorphing ? morphOutputAt : scenes[sceneSelected].outputAt;
 			for (int j = 0; j < PORTS; j+=4) {
 				// Check for OUT_MODE
 				simd::int32_4 o1 = simd::int32_4::load((int32_t*)&scenes[sceneSelected].output[j]);
@@ -332,7 +411,7 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 				// Clamp if outputClamp it set
 				out[j / 4] = simd::ifelse(oc == 1.f, simd::clamp(out[j / 4], -10.f, 10.f), out[j / 4]);
 				// Attenuverters
-				simd::float_4 at = simd::float_4::load(&scenes[sceneSelected].outputAt[j]);
+				simd::float_4 at = simd::float_4::load(&outputAt[j]);
 				//at = outputAtSlew[j / 4].process(args.sampleTime, at);
 				out[j / 4] *= at;
 			}
@@ -392,6 +471,79 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 		rightExpander.messageFlipRequested = true;
 	}
 
+	/**
+	 * Rebuilds the lists of the dense and the sparse kernel: The sparse kernel costs one multiply-add
+	 * per crosspoint, the dense kernel one float_4 multiply-add per four outputs on every input with
+	 * crosspoints. Inputs in fade-mode change their gains on every sample and use the dense kernel.
+	 */
+	void crosspointsUpdate() {
+		crosspointsDirty = false;
+		crosspointCount = 0;
+		denseInputCount = 0;
+		int activeInputs[PORTS];
+		int activeInputCount = 0;
+		for (int i = 0; i < PORTS; i++) {
+			IN_MODE mode = sceneInputMode ? scenes[sceneSelected].input[i] : inputMode[i];
+			if (mode == IN_MODE::IM_OFF) continue;
+			if (mode == IN_MODE::IM_FADE) {
+				denseInputs[denseInputCount++] = i;
+				continue;
+			}
+			int n = crosspointCount;
+			for (int j = 0; j < PORTS; j++) {
+				if (currentMatrix[i][j] == 0.f) continue;
+				crosspoints[crosspointCount++] = Crosspoint{i, j, currentMatrix[i][j]};
+			}
+			if (crosspointCount > n) activeInputs[activeInputCount++] = i;
+		}
+
+		if (crosspointCount * 4 >= activeInputCount * PORTS) {
+			// Dense matrix
+			for (int k = 0; k < activeInputCount; k++) {
+				denseInputs[denseInputCount++] = activeInputs[k];
+			}
+			crosspointCount = 0;
+		}
+	}
+
+	/**
+	 * Blends the matrices and attenuverters of two adjacent scenes into currentMatrix, 0..10V covers
+	 * all active scenes. The state of the faders is left untouched.
+	 */
+	void sceneMorph(float voltage) {
+		float pos = clamp(voltage / 10.f, 0.f, 1.f) * (sceneCount - 1);
+		int s0 = std::min(int(pos), std::max(sceneCount - 2, 0));
+		int s1 = std::min(s0 + 1, sceneCount - 1);
+		float t = pos - s0;
+		simd::float_4 w0, w1;
+		if (sceneMode == SCENE_CV_MODE::MORPH_EQUAL) {
+			w0 = std::cos(t * 0.5f * float(M_PI));
+			w1 = std::sin(t * 0.5f * float(M_PI));
+		}
+		else {
+			w0 = 1.f - t;
+			w1 = t;
+		}
+
+		for (int i = 0; i < PORTS; i++) {
+			for (int j = 0; j < PORTS; j+=4) {
+				simd::float_4 m0 = simd::float_4::load(&scenes[s0].matrix[i][j]);
+				simd::float_4 m1 = simd::float_4::load(&scenes[s1].matrix[i][j]);
+				(m0 * w0 + m1 * w1).store(&currentMatrix[i][j]);
+			}
+		}
+		for (int j = 0; j < PORTS; j+=4) {
+			// Attenuverters follow the panel if they are not part of the scenes
+			if (!sceneAtMode) {
+				simd::float_4::load(&scenes[sceneSelected].outputAt[j]).store(&morphOutputAt[j]);
+				continue;
+			}
+			simd::float_4 a0 = simd::float_4::load(&scenes[s0].outputAt[j]);
+			simd::float_4 a1 = simd::float_4::load(&scenes[s1].outputAt[j]);
+			(a0 * w0 + a1 * w1).store(&morphOutputAt[j]);
+		}
+	}
+
 	inline void sceneSet(int scene) {
 		if (sceneSelected == scene) return;
 		if (scene < 0) return;
@@ -422,13 +574,12 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 			for (int j = 0; j < PORTS; j++) {
 				float p = scenes[sceneSelected].matrix[i][j];
 				params[PARAM_MATRIX + j * PORTS + i].setValue(p);
-				for (int c = 0; c < channelCount; c++) {
-					if (p != scenes[scenePrevious].matrix[i][j] && p == 1.f) fader[i][j][c].triggerFadeIn();
-					if (p != scenes[scenePrevious].matrix[i][j] && p == 0.f) fader[i][j][c].triggerFadeOut();
-				}
+				if (p != scenes[scenePrevious].matrix[i][j] && p == 1.f) fader[i][j / 4].triggerFadeIn(j % 4);
+				if (p != scenes[scenePrevious].matrix[i][j] && p == 0.f) fader[i][j / 4].triggerFadeOut(j % 4);
 				currentMatrix[i][j] = p;
 			}
 		}
+		crosspointsDirty = true;
 		/*
 		for (int i = 0; i < PORTS / 4; i++) {
 			outputAtSlew[i].setRiseFall(at[i] / f1, at[i] / f2);
@@ -459,11 +610,10 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 				scenes[sceneSelected].matrix[i][j] = 0.f;
 				params[PARAM_MATRIX + j * PORTS + i].setValue(0.f);
 				currentMatrix[i][j] = 0.f;
-				for (int c = 0; c < channelCount; c++) {
-					fader[i][j][c].reset(0.f);
-				}
+				fader[i][j / 4].reset(j % 4, 0.f);
 			}
 		}
+		crosspointsDirty = true;
 	}
 
 	void sceneSetCount(int count) {
@@ -483,17 +633,13 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 		if (fadeIn) {
 			fadeInTs[i] = ts;
 			for (int j = 0; j < PORTS; j++) {
-				for (int c = 0; c < channelCount; c++) {
-					fader[i][j][c].setRise(fadeIn[j]);
-				}
+				fader[i][j / 4].setRise(j % 4, fadeIn[j]);
 			}
 		}
 		if (fadeOut) {
 			fadeOutTs[i] = ts;
 			for (int j = 0; j < PORTS; j++) {
-				for (int c = 0; c < channelCount; c++) {
-					fader[i][j][c].setFall(fadeOut[j]);
-				}
+				fader[i][j / 4].setFall(j % 4, fadeOut[j]);
 			}
 		}
 	}
@@ -600,11 +746,10 @@ struct IntermixModule : Module, IntermixBase<PORTS> {
 			for (int j = 0; j < PORTS; j++) {
 				float v = scenes[sceneSelected].matrix[i][j];
 				currentMatrix[i][j] = v;
-				for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
-					fader[i][j][c].reset(v);
-				}
+				fader[i][j / 4].reset(j % 4, v);
 			}
 		}
+		crosspointsDirty = true;
 	}
 };
 
@@ -859,7 +1004,9 @@ struct IntermixWidget : ThemedModuleWidget<IntermixModule<8>> {
 				{ SCENE_CV_MODE::TRIG_FWD, "Trigger" },
 				{ SCENE_CV_MODE::VOLT, "0..10V" },
 				{ SCENE_CV_MODE::C4, "C4-G4" },
-				{ SCENE_CV_MODE::ARM, "Arm" }
+				{ SCENE_CV_MODE::ARM, "Arm" },
+				{ SCENE_CV_MODE::MORPH_LINEAR, "Morph linear" },
+				{ SCENE_CV_MODE::MORPH_EQUAL, "Morph equal-power" }
 			},
 			&module->sceneMode
 		));
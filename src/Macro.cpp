@@ -130,7 +130,7 @@ struct MacroModule : CVMapModuleBase<MAPS> {
 			}
 
 			for (size_t i = 0; i < MAPS; i++) {
-				ParamQuantity* paramQuantity = getParamQuantity(i);
+				ParamQuantity* paramQuantity = resolveParamQuantity(i);
 				scaleParam[i].setParamQuantity(paramQuantity);
 				if (paramQuantity) {
 					if (lastValue[i] != v) {
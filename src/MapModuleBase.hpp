@@ -2,6 +2,7 @@
 #include "plugin.hpp"
 #include "settings.hpp"
 #include "helpers/StripIdFixModule.hpp"
+#include "helpers/ResolvedParam.hpp"
 #include "components/ParamHandleIndicator.hpp"
 #include "components/MenuLabelEx.hpp"
 #include "components/SubMenuSlider.hpp"
@@ -19,6 +20,8 @@ struct MapModuleBase : Module, StripIdFixModule {
 	int mapLen = 0;
 	/** The mapped param handle of each channel */
 	StoermelderPackOne::ParamHandleIndicator paramHandles[MAX_CHANNELS];
+	/** Resolution of paramHandles including range, used by the engine-thread only */
+	ResolvedParam resolvedParams[MAX_CHANNELS];
 
 	/** Channel ID of the learning session */
 	int learningId;
@@ -87,6 +90,11 @@ struct MapModuleBase : Module, StripIdFixModule {
 		return paramQuantity;
 	}
 
+	/** Same as getParamQuantity() but also resolves the Param and its range, must be called from the engine-thread only */
+	inline ParamQuantity* resolveParamQuantity(int id) {
+		return resolvedParams[id].resolve(&paramHandles[id]);
+	}
+
 	virtual void clearMap(int id) {
 		if (paramHandles[id].moduleId < 0) return;
 		learningId = -1;
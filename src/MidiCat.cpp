@@ -2,6 +2,7 @@
 #include "MidiCat.hpp"
 #include "MapModuleBase.hpp"
 #include "helpers/StripIdFixModule.hpp"
+#include "helpers/MidiInputQueue.hpp"
 #include "digital/ScaledMapParam.hpp"
 #include "components/MenuLabelEx.hpp"
 #include "components/SubMenuSlider.hpp"
@@ -15,55 +16,199 @@ namespace MidiCat {
 
 static const char PRESET_FILTERS[] = "VCV Rack module preset (.vcvm):vcvm";
 
+/** Number of rows of the MIDI value tables: one for each MIDI channel followed by one for any channel */
+static const int MIDI_ROWS = 17;
+static const int MIDI_ROW_ANY = 16;
+
+
+/** MIDI output for controller feedback. Messages are not sent immediately but queued in one
+ * slot per CC and note number of each channel (and one slot per mapping for NRPNs), so multiple
+ * changes of the same control are coalesced into the latest value. process() sends the queued
+ * messages within a bandwidth budget: alternately the most recently changed control, so the
+ * control being moved responds quickly, and the control queued for the longest time, so no control
+ * starves while others keep changing. Messages of MIDI_ROW_ANY are sent on the channel selected
+ * for the output.
+ */
 struct MidiCatOutput : midi::Output {
-	int lastValues[128];
-	bool lastGates[128];
+	/** Number of queue slots, CCs and notes of all rows followed by the NRPN-slots */
+	static const int SLOTS = MIDI_ROWS * 256 + MAX_CHANNELS;
+
+	struct Pending {
+		uint8_t row;
+		uint8_t status;
+		uint8_t number;
+		uint8_t value;
+		/** LSB of a 14-bit value, sent right after the MSB on number + 32, -1 for 7-bit messages */
+		int lsb;
+		/** NRPN parameter number selected before the value is sent, RPNs are offset by 16384, -1 if none */
+		int nrpn;
+	};
+
+	/** Intrusive doubly linked list of queue slots */
+	struct SlotList {
+		int prev[SLOTS];
+		int next[SLOTS];
+		int head;
+		int tail;
+
+		void clear() {
+			head = tail = -1;
+		}
+
+		void append(int slot) {
+			prev[slot] = tail;
+			next[slot] = -1;
+			if (tail >= 0) next[tail] = slot;
+			else head = slot;
+			tail = slot;
+		}
+
+		void remove(int slot) {
+			if (prev[slot] >= 0) next[prev[slot]] = next[slot];
+			else head = next[slot];
+			if (next[slot] >= 0) prev[next[slot]] = prev[slot];
+			else tail = prev[slot];
+		}
+	};
+
+	int lastValues[MIDI_ROWS][128];
+	bool lastGates[MIDI_ROWS][128];
+
+	/** Latest message of each slot */
+	Pending pending[SLOTS];
+	bool queued[SLOTS];
+	/** Queued slots ordered by time of their last change, the most recent one last */
+	SlotList recent;
+	/** Queued slots ordered by the time they have been queued, unaffected by coalescing */
+	SlotList age;
+	/** Take the next message from age instead of recent */
+	bool sendOldest;
+	/** Number of messages which can be sent at the moment */
+	float budget;
 
 	MidiCatOutput() {
 		reset();
 	}
 
 	void reset() {
-		for (int n = 0; n < 128; n++) {
-			lastValues[n] = -1;
-			lastGates[n] = false;
+		for (int r = 0; r < MIDI_ROWS; r++) {
+			for (int n = 0; n < 128; n++) {
+				lastValues[r][n] = -1;
+				lastGates[r][n] = false;
+			}
+		}
+		for (int i = 0; i < SLOTS; i++) {
+			queued[i] = false;
 		}
+		recent.clear();
+		age.clear();
+		sendOldest = false;
+		budget = 0.f;
 	}
 
-	void setValue(int value, int cc, bool force = false) {
-		if (value == lastValues[cc] && !force)
+	void setValue(int value, int cc, int row, bool force = false) {
+		if (value == lastValues[row][cc] && !force)
 			return;
-		lastValues[cc] = value;
+		lastValues[row][cc] = value;
 		// CC
-		midi::Message m;
-		m.setStatus(0xb);
-		m.setNote(cc);
-		m.setValue(value);
-		sendMessage(m);
+		enqueue(row * 256 + cc, row, 0xb, cc, value);
+	}
+
+	/** Sends a 14-bit CC as MSB on cc followed by LSB on cc + 32. */
+	void setValue14bit(int value, int cc, int row) {
+		lastValues[row][cc] = value / 128;
+		lastValues[row][cc + 32] = value % 128;
+		enqueue(row * 256 + cc, row, 0xb, cc, value / 128, value % 128);
 	}
 
-	void setGate(int vel, int note, bool noteOffVelocityZero, bool force = false) {
+	/** Sends a NRPN or RPN value by data entry, id is the mapping's id. */
+	void setNrpn(int id, int value, int nrpn, bool is14bit, int row) {
+		int slot = MIDI_ROWS * 256 + id;
+		if (is14bit) enqueue(slot, row, 0xb, 6, value / 128, value % 128, nrpn);
+		else enqueue(slot, row, 0xb, 6, value, -1, nrpn);
+	}
+
+	void setGate(int vel, int note, int row, bool noteOffVelocityZero, bool force = false) {
 		if (vel > 0) {
 			// Note on
-			if (!lastGates[note] || force) {
-				midi::Message m;
-				m.setStatus(0x9);
-				m.setNote(note);
-				m.setValue(vel);
-				sendMessage(m);
+			if (!lastGates[row][note] || force) {
+				enqueue(row * 256 + 128 + note, row, 0x9, note, vel);
 			}
 		}
 		else if (vel == 0) {
 			// Note off
-			if (lastGates[note] || force) {
-				midi::Message m;
-				m.setStatus(noteOffVelocityZero ? 0x9 : 0x8);
-				m.setNote(note);
-				m.setValue(0);
-				sendMessage(m);
+			if (lastGates[row][note] || force) {
+				enqueue(row * 256 + 128 + note, row, noteOffVelocityZero ? 0x9 : 0x8, note, 0);
 			}
 		}
-		lastGates[note] = vel > 0;
+		lastGates[row][note] = vel > 0;
+	}
+
+	void enqueue(int slot, int row, uint8_t status, int number, int value, int lsb = -1, int nrpn = -1) {
+		Pending& p = pending[slot];
+		p.row = row;
+		p.status = status;
+		p.number = number;
+		p.value = value;
+		p.lsb = lsb;
+		p.nrpn = nrpn;
+		if (queued[slot]) {
+			// Coalesce with the queued message, the slot keeps its place in age
+			recent.remove(slot);
+			recent.append(slot);
+			return;
+		}
+		queued[slot] = true;
+		recent.append(slot);
+		age.append(slot);
+	}
+
+	/** Sends queued messages, rate is the number of messages per millisecond or 0 for unlimited.
+	 * The budget accumulates for up to 4ms, allowing short bursts.
+	 */
+	void process(float sampleTime, float rate) {
+		if (rate > 0.f) {
+			budget = std::min(budget + rate * 1000.f * sampleTime, std::max(rate * 4.f, 4.f));
+		}
+		while (recent.tail >= 0) {
+			int slot = sendOldest ? age.head : recent.tail;
+			Pending& p = pending[slot];
+			float cost = 1.f + (p.lsb >= 0 ? 1.f : 0.f) + (p.nrpn >= 0 ? 2.f : 0.f);
+			if (rate > 0.f) {
+				if (budget < cost) break;
+				budget -= cost;
+			}
+			recent.remove(slot);
+			age.remove(slot);
+			queued[slot] = false;
+			sendOldest ^= true;
+
+			if (p.nrpn >= 0) {
+				bool rpn = p.nrpn >= 16384;
+				int n = p.nrpn & 16383;
+				send(p.row, 0xb, rpn ? 101 : 99, n / 128);
+				send(p.row, 0xb, rpn ? 100 : 98, n % 128);
+			}
+			send(p.row, p.status, p.number, p.value);
+			if (p.lsb >= 0) {
+				send(p.row, p.status, p.number + 32, p.lsb);
+			}
+		}
+	}
+
+	void send(int row, uint8_t status, int number, int value) {
+		midi::Message m;
+		m.setStatus(status);
+		m.setNote(number);
+		m.setValue(value);
+		if (row == MIDI_ROW_ANY) {
+			sendMessage(m);
+		}
+		else if (outputDevice) {
+			// Bypass the channel of the output
+			m.setChannel(row);
+			outputDevice->sendMessage(m);
+		}
 	}
 };
 
@@ -81,20 +226,55 @@ struct MidiCatParam : ScaledMapParam<int> {
 		ARM_DEFERRED_FEEDBACK = 2
 	};
 
+	/** Values received in longer intervals are not considered as a continuous movement */
+	static constexpr float RAMP_MAX = 0.1f;
+
 	CLOCKMODE clockMode = CLOCKMODE::OFF;
 	int clockSource = 0;
 
 	int setValueDeffered;
 	int getValueLast;
 
+	/** [Stored to Json] Ramp linearly to each new value over the interval since the previous one */
+	bool ramp = false;
+	float rampFrom;
+	float rampValue;
+	float rampLength;
+	float rampPos = 1.f;
+
 	void reset(bool resetSettings = true) override {
 		if (resetSettings) {
 			clockMode = CLOCKMODE::OFF;
 			clockSource = 0;
+			ramp = false;
 		}
+		rampPos = 1.f;
 		ScaledMapParam<int>::reset(resetSettings);
 	}
 
+	/** Starts a ramp for the next call of setValue(), interval is the time since the previous value
+	 * in seconds. The next process() call covers the time since the previous one which has to be
+	 * excluded from the ramp, hence it is passed as elapsed.
+	 */
+	void setRamp(float interval, float elapsed) {
+		if (!ramp || clockMode != CLOCKMODE::OFF || value < 0.f || interval <= 0.f || interval > RAMP_MAX) {
+			rampPos = 1.f;
+			return;
+		}
+		rampFrom = rampPos < 1.f ? rampValue : value;
+		rampLength = interval;
+		rampPos = -elapsed / interval;
+	}
+
+	float processValue(float sampleTime) override {
+		float v = value;
+		if (rampPos < 1.f) {
+			rampPos = std::min(rampPos + sampleTime / rampLength, 1.f);
+			v = rampValue = rampFrom + (value - rampFrom) * std::max(rampPos, 0.f);
+		}
+		return filterSlew > 0.f && sampleTime > 0.f ? filter.process(sampleTime, v) : v;
+	}
+
 	void setValue(int i) override {
 		switch (clockMode) {
 			case CLOCKMODE::OFF:
@@ -146,7 +326,7 @@ struct MidiCatParam : ScaledMapParam<int> {
 
 struct MidiCatModule : Module, StripIdFixModule {
 	/** [Stored to Json] */
-	midi::InputQueue midiInput;
+	MidiInputQueue<> midiInput;
 	/** [Stored to Json] */
 	MidiCatOutput midiOutput;
 
@@ -165,18 +345,35 @@ struct MidiCatModule : Module, StripIdFixModule {
 		CCMODE ccMode;
 		/** [Stored to Json] */
 		bool cc14bit = false;
+		/** [Stored to Json] NRPN parameter number, RPNs are offset by 16384, -1 for plain CCs.
+		 * NRPN values are received by data entry, i.e. cc is 6 and its LSB is 38 */
+		int nrpn = -1;
+		/** Latest data entry MSB and LSB of the NRPN */
+		int nrpnValues[2];
+		uint32_t nrpnTs[2] = {0, 0};
 
 		bool process() {
 			int previous = current;
+			const int* values = nrpnValues;
+			const uint32_t* valuesTs = nrpnTs;
+			int msb = 0;
+			int lsb = 1;
+			if (nrpn < 0) {
+				int row = module->midiRow(id);
+				values = module->valuesCc[row];
+				valuesTs = module->valuesCcTs[row];
+				msb = cc;
+				lsb = cc + 32;
+			}
 			if (cc14bit) {
-				if (module->valuesCcTs[cc] > lastTs && module->valuesCcTs[cc + 32] > lastTs) {
-					current = module->valuesCc[cc] * 128 + module->valuesCc[cc + 32];
+				if (valuesTs[msb] > lastTs && valuesTs[lsb] > lastTs) {
+					current = values[msb] * 128 + values[lsb];
 					lastTs = module->ts;
 				}
 			}
 			else {
-				if (module->valuesCcTs[cc] > lastTs) {
-					current = module->valuesCc[cc];
+				if (valuesTs[msb] > lastTs) {
+					current = values[msb];
 					lastTs = module->ts;
 				}
 			}
@@ -189,19 +386,24 @@ struct MidiCatModule : Module, StripIdFixModule {
 
 		void setValue(int value, bool sendOnly) {
 			if (cc == -1) return;
-			if (cc14bit) {
-				module->midiOutput.setValue(value / 128, cc, true);
-				module->midiOutput.setValue(value % 128, cc + 32, true);
+			int row = module->midiRow(id);
+			if (nrpn >= 0) {
+				module->midiOutput.setNrpn(id, value, nrpn, cc14bit, row);
+			}
+			else if (cc14bit) {
+				module->midiOutput.setValue14bit(value, cc, row);
 			}
 			else {
-				module->midiOutput.setValue(value, cc, current == -1);
+				module->midiOutput.setValue(value, cc, row, current == -1);
 			}
 			if (!sendOnly) current = value;
 		}
 
 		void reset() {
 			cc = -1;
+			nrpn = -1;
 			current = -1;
+			module->mapIndexDirty = true;
 		}
 
 		void resetValue() {
@@ -212,10 +414,17 @@ struct MidiCatModule : Module, StripIdFixModule {
 			return cc;
 		}
 
-		void setCc(int cc) {
+		int getNrpn() {
+			return nrpn;
+		}
+
+		void setCc(int cc, int nrpn = -1) {
 			this->cc = cc;
+			this->nrpn = cc >= 0 ? nrpn : -1;
 			if (cc == -1 || cc > 32) set14bit(false);
+			nrpnTs[0] = nrpnTs[1] = 0;
 			current = -1;
+			module->mapIndexDirty = true;
 		}
 
 		bool get14bit() {
@@ -225,6 +434,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 		void set14bit(bool value) {
 			cc14bit = value;
 			current = -1;
+			module->mapIndexDirty = true;
 			if (cc14bit) {
 				module->midiParam[id].setLimits(0, 128 * 128 - 1, -1);
 			}
@@ -247,8 +457,9 @@ struct MidiCatModule : Module, StripIdFixModule {
 
 		bool process() {
 			int previous = current;
-			if (module->valuesNoteTs[note] > lastTs) {
-				current = module->valuesNote[note];
+			int row = module->midiRow(id);
+			if (module->valuesNoteTs[row][note] > lastTs) {
+				current = module->valuesNote[row][note];
 				lastTs = module->ts;
 			}
 			return current >= 0 && current != previous;
@@ -260,13 +471,14 @@ struct MidiCatModule : Module, StripIdFixModule {
 
 		void setValue(int value, bool sendOnly) {
 			if (note == -1) return;
-			module->midiOutput.setGate(value, note, (module->midiOptions[id] >> MIDIOPTION_VELZERO_BIT) & 1U, current == -1);
+			module->midiOutput.setGate(value, note, module->midiRow(id), (module->midiOptions[id] >> MIDIOPTION_VELZERO_BIT) & 1U, current == -1);
 			if (!sendOnly) current = value;
 		}
 
 		void reset() {
 			note = -1;
 			current = -1;
+			module->mapIndexDirty = true;
 		}
 
 		void resetValue() {
@@ -280,9 +492,54 @@ struct MidiCatModule : Module, StripIdFixModule {
 		void setNote(int note) {
 			this->note = note;
 			current = -1;
+			module->mapIndexDirty = true;
+		}
+	};
+
+	/** Lists of mapping ids for each CC or note number, stored as linked lists in a shared pool */
+	template<int SIZE>
+	struct MapIndex {
+		int head[128];
+		int next[SIZE];
+		int mapId[SIZE];
+		int len;
+
+		void clear() {
+			for (int i = 0; i < 128; i++) head[i] = -1;
+			len = 0;
+		}
+
+		/** Prepends the mapping id, i.e. ids must be added in descending order to be iterated in ascending order */
+		void add(int number, int id) {
+			mapId[len] = id;
+			next[len] = head[number];
+			head[number] = len++;
 		}
 	};
 
+	/** Set whenever a CC or note of any mapping has been changed */
+	bool mapIndexDirty = true;
+	/** Mapping ids addressed by each CC number, 14-bit CCs are listed on both MSB and LSB */
+	MapIndex<2 * MAX_CHANNELS> ccIndex;
+	/** Mapping ids addressed by each note number */
+	MapIndex<MAX_CHANNELS> noteIndex;
+	/** Mapping ids of NRPNs, listed by the lower 7 bits of the parameter number */
+	MapIndex<MAX_CHANNELS> nrpnIndex;
+	/** Ids of all mappings having a CC or note, in ascending order */
+	int mapActive[MAX_CHANNELS];
+	int mapActiveLen = 0;
+	/** Mappings addressed by MIDI messages since the last call of processMappings() */
+	bool mapPending[MAX_CHANNELS];
+	int mapPendingIds[MAX_CHANNELS];
+	int mapPendingLen = 0;
+	/** Forces processing of all active mappings on the next periodic pass */
+	bool mapProcessAll = true;
+	/** Value of the mapped parameter after the last processing of each mapping */
+	float paramValueLast[MAX_CHANNELS];
+	/** Sample counter of the last processing and of the last new value of each mapping */
+	uint32_t processTs[MAX_CHANNELS];
+	uint32_t valueTs[MAX_CHANNELS];
+
 	/** Number of maps */
 	int mapLen = 0;
 	/** [Stored to Json] The mapped CC number of each channel */
@@ -291,6 +548,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 	MidiNoteAdapter notes[MAX_CHANNELS];
 	/** [Stored to JSON] */
 	int midiOptions[MAX_CHANNELS];
+	/** [Stored to Json] The MIDI channel of each mapping, -1 for any channel */
+	int midiChannel[MAX_CHANNELS];
 	/** [Stored to JSON] */
 	bool midiIgnoreDevices;
 	/** [Stored to JSON] */
@@ -298,6 +557,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 
 	/** [Stored to Json] The mapped param handle of each channel */
 	ParamHandleIndicator paramHandles[MAX_CHANNELS];
+	/** Resolution of paramHandles including range, used by the engine-thread only */
+	ResolvedParam resolvedParams[MAX_CHANNELS];
 
 	/** Channel ID of the learning session */
 	int learningId;
@@ -309,6 +570,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 	/** Whether the note has been set during the learning session */
 	bool learnedNote;
 	int learnedNoteLast = -1;
+	int learnedNrpnLast = -1;
 	/** Whether the param has been set during the learning session */
 	bool learnedParam;
 
@@ -325,12 +587,16 @@ struct MidiCatModule : Module, StripIdFixModule {
 
 	uint32_t ts = 0;
 
-	/** The value of each CC number */
-	int valuesCc[128];
-	uint32_t valuesCcTs[128];
-	/** The value of each note number */
-	int valuesNote[128];
-	uint32_t valuesNoteTs[128];
+	/** The value of each CC number on each MIDI channel and on any channel */
+	int valuesCc[MIDI_ROWS][128];
+	uint32_t valuesCcTs[MIDI_ROWS][128];
+	/** The value of each note number on each MIDI channel and on any channel */
+	int valuesNote[MIDI_ROWS][128];
+	uint32_t valuesNoteTs[MIDI_ROWS][128];
+	/** Last NRPN (CC 99) or RPN (CC 101, offset by 128) parameter number MSB on each MIDI channel, -1 if none */
+	int nrpnMsb[16];
+	/** NRPN parameter number selected on each MIDI channel, RPNs are offset by 16384, -1 if none */
+	int nrpnSelected[16];
 
 	MIDIMODE midiMode = MIDIMODE::MIDIMODE_DEFAULT;
 
@@ -348,6 +614,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 	/** [Stored to Json] */
 	bool midiResendPeriodically;
 	dsp::ClockDivider midiResendDivider;
+	/** [Stored to Json] Maximum number of MIDI feedback messages per millisecond, 0 for unlimited */
+	float midiFeedbackRate;
 
 	dsp::ClockDivider processDivider;
 	/** [Stored to Json] */
@@ -370,12 +638,17 @@ struct MidiCatModule : Module, StripIdFixModule {
 	MidiCatModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
 		config(0, 0, 0, 0);
+		// MIDI clock and other messages not used for mapping never reach the queue
+		midiInput.statusMask = MidiInputQueue<>::STATUS_NOTE | MidiInputQueue<>::STATUS_CC;
 		for (int id = 0; id < MAX_CHANNELS; id++) {
 			paramHandles[id].color = mappingIndicatorColor;
 			APP->engine->addParamHandle(&paramHandles[id]);
 			midiParam[id].setLimits(0, 127, -1);
 			ccs[id].module = notes[id].module = this;
 			ccs[id].id = notes[id].id = id;
+			mapPending[id] = false;
+			paramValueLast[id] = 0.f;
+			processTs[id] = valueTs[id] = 0;
 		}
 		indicatorDivider.setDivision(2048);
 		midiResendDivider.setDivision(APP->engine->getSampleRate() / 2);
@@ -397,11 +670,17 @@ struct MidiCatModule : Module, StripIdFixModule {
 		// We also might be in the MIDIMap() constructor, which could cause problems, but when constructing, all ParamHandles will point to no Modules anyway.
 		clearMaps_NoLock();
 		mapLen = 1;
-		for (int i = 0; i < 128; i++) {
-			valuesCc[i] = -1;
-			valuesCcTs[i] = 0;
-			valuesNote[i] = -1;
-			valuesNoteTs[i] = 0;
+		for (int r = 0; r < MIDI_ROWS; r++) {
+			for (int i = 0; i < 128; i++) {
+				valuesCc[r][i] = -1;
+				valuesCcTs[r][i] = 0;
+				valuesNote[r][i] = -1;
+				valuesNoteTs[r][i] = 0;
+			}
+		}
+		for (int c = 0; c < 16; c++) {
+			nrpnMsb[c] = -1;
+			nrpnSelected[c] = -1;
 		}
 		for (int i = 0; i < MAX_CHANNELS; i++) {
 			lastValueIn[i] = -1;
@@ -410,6 +689,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 			notes[i].noteMode = NOTEMODE::MOMENTARY;
 			textLabel[i] = "";
 			midiOptions[i] = 0;
+			midiChannel[i] = -1;
 			midiParam[i].reset();
 		}
 		locked = false;
@@ -419,6 +699,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 		midiIgnoreDevices = false;
 		midiResendPeriodically = false;
 		midiResendDivider.reset();
+		midiFeedbackRate = 1.f;
 		processDivision = 64;
 		processDivider.setDivision(processDivision);
 		processDivider.reset();
@@ -433,20 +714,25 @@ struct MidiCatModule : Module, StripIdFixModule {
 	void process(const ProcessArgs &args) override {
 		ts++;
 
-		// Aquire new MIDI messages from the queue
+		if (mapIndexDirty) {
+			mapIndexUpdate();
+		}
+
+		// Aquire new MIDI messages from the queue, each message marks the mappings it addresses.
+		// Messages are popped on the frame of their timestamp and the addressed mappings are
+		// stepped on the same frame, independent from the processDivision.
 		midi::Message msg;
-		bool midiReceived = false;
 		while (midiInput.tryPop(&msg, args.frame)) {
-			bool r = midiProcessMessage(msg);
-			midiReceived = midiReceived || r;
+			midiProcessMessage(msg);
 		}
 
-		// Only step channels when some midi event has been received. Additionally
-		// step channels for parameter changes made manually every 128th loop. Notice
+		// Only step the mappings addressed by some midi event. Additionally step mappings with
+		// running slew, armed clock or parameter changes made manually periodically. Notice
 		// that midi allows about 1000 messages per second, so checking for changes more often
 		// won't lead to higher precision on midi output.
-		if (processDivider.process() || midiReceived) {
-			processMappings(args.sampleTime);
+		bool periodic = processDivider.process();
+		if (periodic || mapPendingLen > 0) {
+			processMappings(args.sampleTime, periodic);
 		}
 
 		// Handle indicators - blinking
@@ -464,6 +750,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 			midiResendFeedback();
 		}
 
+		midiOutput.process(args.sampleTime, midiFeedbackRate);
+
 		// Expanders
 		bool expMemFound = false;
 		bool expCtxFound = false;
@@ -513,193 +801,224 @@ struct MidiCatModule : Module, StripIdFixModule {
 		}
 	}
 
-	void processMappings(float sampleTime) {
-		float st = sampleTime * float(processDivision);
+	void processMappings(float sampleTime, bool periodic) {
+		if (periodic) {
+			bool all = mapProcessAll;
+			mapProcessAll = false;
+			for (int i = 0; i < mapActiveLen; i++) {
+				int id = mapActive[i];
+				processMapping(id, sampleTime, all || mapPending[id]);
+			}
+		}
+		else {
+			for (int i = 0; i < mapPendingLen; i++) {
+				processMapping(mapPendingIds[i], sampleTime, true);
+			}
+		}
 
-		for (int id = 0; id < mapLen; id++) {
-			int cc = ccs[id].getCc();
-			int note = notes[id].getNote();
-			if (cc < 0 && note < 0)
-				continue;
+		for (int i = 0; i < mapPendingLen; i++) {
+			mapPending[mapPendingIds[i]] = false;
+		}
+		mapPendingLen = 0;
+	}
 
-			// Get Module
-			Module* module = paramHandles[id].module;
-			if (!module)
-				continue;
+	/** Returns true if the mapping has neither running slew nor an armed clock and the mapped
+	 * parameter has not been changed since the last processing, i.e. no MIDI feedback is due.
+	 */
+	bool processMappingIdle(int id) {
+		MidiCatParam& p = midiParam[id];
+		return p.clockMode == MidiCatParam::CLOCKMODE::OFF
+			&& p.filterInitialized
+			&& p.value == p.valueOut
+			&& resolvedParams[id].param->getValue() == paramValueLast[id];
+	}
 
-			// Get ParamQuantity
-			int paramId = paramHandles[id].paramId;
-			ParamQuantity* paramQuantity = module->paramQuantities[paramId];
-			if (!paramQuantity)
-				continue;
+	/** Steps a single mapping, idle mappings are skipped unless force is set. */
+	void processMapping(int id, float sampleTime, bool force) {
+		if (id >= mapLen)
+			return;
+		int cc = ccs[id].getCc();
+		int note = notes[id].getNote();
+		if (cc < 0 && note < 0)
+			return;
 
-			if (!paramQuantity->isBounded())
-				continue;
+		ParamQuantity* paramQuantity = resolvedParams[id].resolve(&paramHandles[id]);
+		if (!paramQuantity)
+			return;
 
-			switch (midiMode) {
-				case MIDIMODE::MIDIMODE_DEFAULT: {
-					midiParam[id].paramQuantity = paramQuantity;
-					int t = -1;
-
-					// Check if CC value has been set and changed
-					if (cc >= 0 && ccs[id].process()) {
-						switch (ccs[id].ccMode) {
-							case CCMODE::DIRECT:
-								if (lastValueIn[id] != ccs[id].getValue()) {
-									lastValueIn[id] = ccs[id].getValue();
+		switch (midiMode) {
+			case MIDIMODE::MIDIMODE_DEFAULT: {
+				if (!force && processMappingIdle(id))
+					return;
+				// Time since the last step of this mapping, which is shorter than the regular
+				// period if the mapping has been stepped by an incoming message
+				uint32_t steps = std::max(std::min(ts - processTs[id], (uint32_t)processDivision), 1u);
+				float st = sampleTime * float(steps);
+				processTs[id] = ts;
+				midiParam[id].paramQuantity = paramQuantity;
+				int t = -1;
+
+				// Check if CC value has been set and changed
+				if (cc >= 0 && ccs[id].process()) {
+					switch (ccs[id].ccMode) {
+						case CCMODE::DIRECT:
+							if (lastValueIn[id] != ccs[id].getValue()) {
+								lastValueIn[id] = ccs[id].getValue();
+								t = ccs[id].getValue();
+							}
+							break;
+						case CCMODE::PICKUP1:
+							if (lastValueIn[id] != ccs[id].getValue()) {
+								if (midiParam[id].isNear(lastValueIn[id])) {
+									midiParam[id].resetFilter();
 									t = ccs[id].getValue();
 								}
-								break;
-							case CCMODE::PICKUP1:
-								if (lastValueIn[id] != ccs[id].getValue()) {
-									if (midiParam[id].isNear(lastValueIn[id])) {
-										midiParam[id].resetFilter();
-										t = ccs[id].getValue();
-									}
-									lastValueIn[id] = ccs[id].getValue();
-								}
-								break;
-							case CCMODE::PICKUP2:
-								if (lastValueIn[id] != ccs[id].getValue()) {
-									if (midiParam[id].isNear(lastValueIn[id], ccs[id].getValue())) {
-										midiParam[id].resetFilter();
-										t = ccs[id].getValue();
-									}
-									lastValueIn[id] = ccs[id].getValue();
-								}
-								break;
-							case CCMODE::TOGGLE:
-								if (ccs[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
-									t = midiParam[id].getLimitMax();
-									lastValueIn[id] = -2;
-								} 
-								else if (ccs[id].getValue() == 0 && lastValueIn[id] == -2) {
-									t = midiParam[id].getLimitMax();
-									lastValueIn[id] = -3;
-								}
-								else if (ccs[id].getValue() > 0 && lastValueIn[id] == -3) {
-									t = midiParam[id].getLimitMin();
-									lastValueIn[id] = -4;
-								}
-								else if (ccs[id].getValue() == 0 && lastValueIn[id] == -4) {
-									t = midiParam[id].getLimitMin();
-									lastValueIn[id] = -1;
-								}
-								break;
-							case CCMODE::TOGGLE_VALUE:
-								if (ccs[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
+								lastValueIn[id] = ccs[id].getValue();
+							}
+							break;
+						case CCMODE::PICKUP2:
+							if (lastValueIn[id] != ccs[id].getValue()) {
+								if (midiParam[id].isNear(lastValueIn[id], ccs[id].getValue())) {
+									midiParam[id].resetFilter();
 									t = ccs[id].getValue();
-									lastValueIn[id] = -2;
-								} 
-								else if (ccs[id].getValue() == 0 && lastValueIn[id] == -2) {
-									t = midiParam[id].getValue();
-									lastValueIn[id] = -3;
-								}
-								else if (ccs[id].getValue() > 0 && lastValueIn[id] == -3) {
-									t = midiParam[id].getLimitMin();
-									lastValueIn[id] = -4;
-								}
-								else if (ccs[id].getValue() == 0 && lastValueIn[id] == -4) {
-									t = midiParam[id].getLimitMin();
-									lastValueIn[id] = -1;
-								}
-								break;
-						}
-					}
-
-					// Check if note value has been set and changed
-					if (note >= 0 && notes[id].process()) {
-						switch (notes[id].noteMode) {
-							case NOTEMODE::MOMENTARY:
-								if (lastValueIn[id] != notes[id].getValue()) {
-									t = notes[id].getValue();
-									if (t > 0) t = 127;
-									lastValueIn[id] = notes[id].getValue();
-								} 
-								break;
-							case NOTEMODE::MOMENTARY_VEL:
-								if (lastValueIn[id] != notes[id].getValue()) {
-									t = notes[id].getValue();
-									lastValueIn[id] = notes[id].getValue();
-								}
-								break;
-							case NOTEMODE::TOGGLE:
-								if (notes[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
-									t = 127;
-									lastValueIn[id] = -2;
-								} 
-								else if (notes[id].getValue() == 0 && lastValueIn[id] == -2) {
-									t = 127;
-									lastValueIn[id] = -3;
-								}
-								else if (notes[id].getValue() > 0 && lastValueIn[id] == -3) {
-									t = 0;
-									lastValueIn[id] = -4;
-								}
-								else if (notes[id].getValue() == 0 && lastValueIn[id] == -4) {
-									t = 0;
-									lastValueIn[id] = -1;
-								}
-								break;
-							case NOTEMODE::TOGGLE_VEL:
-								if (notes[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
-									t = notes[id].getValue();
-									lastValueIn[id] = -2;
-								} 
-								else if (notes[id].getValue() == 0 && lastValueIn[id] == -2) {
-									t = midiParam[id].getValue();
-									lastValueIn[id] = -3;
-								}
-								else if (notes[id].getValue() > 0 && lastValueIn[id] == -3) {
-									t = 0;
-									lastValueIn[id] = -4;
 								}
-								else if (notes[id].getValue() == 0 && lastValueIn[id] == -4) {
-									t = 0;
-									lastValueIn[id] = -1;
-								}
-								break;
-						}
+								lastValueIn[id] = ccs[id].getValue();
+							}
+							break;
+						case CCMODE::TOGGLE:
+							if (ccs[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
+								t = midiParam[id].getLimitMax();
+								lastValueIn[id] = -2;
+							} 
+							else if (ccs[id].getValue() == 0 && lastValueIn[id] == -2) {
+								t = midiParam[id].getLimitMax();
+								lastValueIn[id] = -3;
+							}
+							else if (ccs[id].getValue() > 0 && lastValueIn[id] == -3) {
+								t = midiParam[id].getLimitMin();
+								lastValueIn[id] = -4;
+							}
+							else if (ccs[id].getValue() == 0 && lastValueIn[id] == -4) {
+								t = midiParam[id].getLimitMin();
+								lastValueIn[id] = -1;
+							}
+							break;
+						case CCMODE::TOGGLE_VALUE:
+							if (ccs[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
+								t = ccs[id].getValue();
+								lastValueIn[id] = -2;
+							} 
+							else if (ccs[id].getValue() == 0 && lastValueIn[id] == -2) {
+								t = midiParam[id].getValue();
+								lastValueIn[id] = -3;
+							}
+							else if (ccs[id].getValue() > 0 && lastValueIn[id] == -3) {
+								t = midiParam[id].getLimitMin();
+								lastValueIn[id] = -4;
+							}
+							else if (ccs[id].getValue() == 0 && lastValueIn[id] == -4) {
+								t = midiParam[id].getLimitMin();
+								lastValueIn[id] = -1;
+							}
+							break;
 					}
+				}
 
-					// Set a new value for the mapped parameter
-					if (t >= 0) {
-						midiParam[id].setValue(t);
-						if (overlayEnabled && overlayQueue.capacity() > 0) overlayQueue.push(id);
+				// Check if note value has been set and changed
+				if (note >= 0 && notes[id].process()) {
+					switch (notes[id].noteMode) {
+						case NOTEMODE::MOMENTARY:
+							if (lastValueIn[id] != notes[id].getValue()) {
+								t = notes[id].getValue();
+								if (t > 0) t = 127;
+								lastValueIn[id] = notes[id].getValue();
+							} 
+							break;
+						case NOTEMODE::MOMENTARY_VEL:
+							if (lastValueIn[id] != notes[id].getValue()) {
+								t = notes[id].getValue();
+								lastValueIn[id] = notes[id].getValue();
+							}
+							break;
+						case NOTEMODE::TOGGLE:
+							if (notes[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
+								t = 127;
+								lastValueIn[id] = -2;
+							} 
+							else if (notes[id].getValue() == 0 && lastValueIn[id] == -2) {
+								t = 127;
+								lastValueIn[id] = -3;
+							}
+							else if (notes[id].getValue() > 0 && lastValueIn[id] == -3) {
+								t = 0;
+								lastValueIn[id] = -4;
+							}
+							else if (notes[id].getValue() == 0 && lastValueIn[id] == -4) {
+								t = 0;
+								lastValueIn[id] = -1;
+							}
+							break;
+						case NOTEMODE::TOGGLE_VEL:
+							if (notes[id].getValue() > 0 && (lastValueIn[id] == -1 || lastValueIn[id] >= 0)) {
+								t = notes[id].getValue();
+								lastValueIn[id] = -2;
+							} 
+							else if (notes[id].getValue() == 0 && lastValueIn[id] == -2) {
+								t = midiParam[id].getValue();
+								lastValueIn[id] = -3;
+							}
+							else if (notes[id].getValue() > 0 && lastValueIn[id] == -3) {
+								t = 0;
+								lastValueIn[id] = -4;
+							}
+							else if (notes[id].getValue() == 0 && lastValueIn[id] == -4) {
+								t = 0;
+								lastValueIn[id] = -1;
+							}
+							break;
 					}
+				}
 
-					// Apply value on the mapped parameter (respecting slew and scale)
-					midiParam[id].process(st);
+				// Set a new value for the mapped parameter
+				if (t >= 0) {
+					midiParam[id].setRamp(sampleTime * float(ts - valueTs[id]), st);
+					valueTs[id] = ts;
+					midiParam[id].setValue(t);
+					if (overlayEnabled && overlayQueue.capacity() > 0) overlayQueue.push(id);
+				}
 
-					// Retrieve the current value of the parameter (ignoring slew and scale)
-					int v = midiParam[id].getValue();
+				// Apply value on the mapped parameter (respecting slew and scale)
+				midiParam[id].process(st);
 
-					// Midi feedback
-					if (lastValueOut[id] != v) {
-						if (cc >= 0 && ccs[id].ccMode == CCMODE::DIRECT)
-							lastValueIn[id] = v;
-						ccs[id].setValue(v, lastValueIn[id] < 0);
-						notes[id].setValue(v, lastValueIn[id] < 0);
-						lastValueOut[id] = v;
-					}
-				} break;
+				// Retrieve the current value of the parameter (ignoring slew and scale)
+				int v = midiParam[id].getValue();
 
-				case MIDIMODE::MIDIMODE_LOCATE: {
-					bool indicate = false;
-					if ((cc >= 0 && ccs[id].getValue() >= 0) && lastValueInIndicate[id] != ccs[id].getValue()) {
-						lastValueInIndicate[id] = ccs[id].getValue();
-						indicate = true;
-					}
-					if ((note >= 0 && notes[id].getValue() >= 0) && lastValueInIndicate[id] != notes[id].getValue()) {
-						lastValueInIndicate[id] = notes[id].getValue();
-						indicate = true;
-					}
-					if (indicate) {
-						ModuleWidget* mw = APP->scene->rack->getModule(paramQuantity->module->id);
-						paramHandles[id].indicate(mw);
-					}
-				} break;
-			}
+				// Midi feedback
+				if (lastValueOut[id] != v) {
+					if (cc >= 0 && ccs[id].ccMode == CCMODE::DIRECT)
+						lastValueIn[id] = v;
+					ccs[id].setValue(v, lastValueIn[id] < 0);
+					notes[id].setValue(v, lastValueIn[id] < 0);
+					lastValueOut[id] = v;
+				}
+				paramValueLast[id] = resolvedParams[id].param->getValue();
+			} break;
+
+			case MIDIMODE::MIDIMODE_LOCATE: {
+				bool indicate = false;
+				if ((cc >= 0 && ccs[id].getValue() >= 0) && lastValueInIndicate[id] != ccs[id].getValue()) {
+					lastValueInIndicate[id] = ccs[id].getValue();
+					indicate = true;
+				}
+				if ((note >= 0 && notes[id].getValue() >= 0) && lastValueInIndicate[id] != notes[id].getValue()) {
+					lastValueInIndicate[id] = notes[id].getValue();
+					indicate = true;
+				}
+				if (indicate) {
+					ModuleWidget* mw = APP->scene->rack->getModule(paramQuantity->module->id);
+					paramHandles[id].indicate(mw);
+				}
+			} break;
 		}
 	}
 
@@ -732,57 +1051,154 @@ struct MidiCatModule : Module, StripIdFixModule {
 	bool midiCc(midi::Message msg) {
 		uint8_t cc = msg.getNote();
 		uint8_t value = msg.getValue();
+		int ch = msg.getChannel();
+		// NRPN and RPN parameter numbers
+		switch (cc) {
+			case 99:
+			case 101:
+				nrpnMsb[ch] = value + (cc == 101 ? 128 : 0);
+				break;
+			case 98:
+			case 100: {
+				int rpn = cc == 100 ? 128 : 0;
+				int msb = nrpnMsb[ch] >= 0 && (nrpnMsb[ch] & 128) == rpn ? nrpnMsb[ch] & 127 : 0;
+				int n = msb * 128 + value;
+				// RPN 127/127 is "null", deselecting the current parameter
+				nrpnSelected[ch] = rpn && n == 16383 ? -1 : n + (rpn ? 16384 : 0);
+			} break;
+		}
+		int nrpn = (cc == 6 || cc == 38) ? nrpnSelected[ch] : -1;
 		// Learn
-		if (learningId >= 0 && learnedCcLast != cc && learnedCcLast != cc - 32 && valuesCc[cc] != value) {
-			ccs[learningId].setCc(cc);
-			ccs[learningId].ccMode = CCMODE::DIRECT;
-			notes[learningId].setNote(-1);
-			learnedCc = true;
-			learnedCcLast = cc;
-			commitLearn();
-			updateMapLen();
-			refreshParamHandleText(learningId);
+		if (learningId >= 0 && !(cc >= 98 && cc <= 101)) {
+			if (nrpn >= 0) {
+				if (learnedNrpnLast != nrpn) {
+					ccs[learningId].setCc(6, nrpn);
+					learnMidi(true, ch);
+					learnedNrpnLast = nrpn;
+				}
+			}
+			else if (learnedCcLast != cc && learnedCcLast != cc - 32 && valuesCc[MIDI_ROW_ANY][cc] != value) {
+				ccs[learningId].setCc(cc);
+				learnMidi(true, ch);
+				learnedCcLast = cc;
+			}
+		}
+		bool midiReceived = valuesCc[MIDI_ROW_ANY][cc] != value;
+		valuesCc[ch][cc] = valuesCc[MIDI_ROW_ANY][cc] = value;
+		valuesCcTs[ch][cc] = valuesCcTs[MIDI_ROW_ANY][cc] = ts;
+		mapMarkPending(ccIndex, cc, ch);
+		if (nrpn >= 0) {
+			for (int e = nrpnIndex.head[nrpn & 127]; e >= 0; e = nrpnIndex.next[e]) {
+				int id = nrpnIndex.mapId[e];
+				if (ccs[id].getNrpn() != nrpn || (midiChannel[id] >= 0 && midiChannel[id] != ch)) continue;
+				ccs[id].nrpnValues[cc == 38] = value;
+				ccs[id].nrpnTs[cc == 38] = ts;
+				mapMarkPending(id);
+			}
 		}
-		bool midiReceived = valuesCc[cc] != value;
-		valuesCc[cc] = value;
-		valuesCcTs[cc] = ts;
 		return midiReceived;
 	}
 
 	bool midiNotePress(midi::Message msg) {
 		uint8_t note = msg.getNote();
 		uint8_t vel = msg.getValue();
+		int ch = msg.getChannel();
 		// Learn
 		if (learningId >= 0 && learnedNoteLast != note) {
 			ccs[learningId].setCc(-1);
 			notes[learningId].setNote(note);
 			notes[learningId].noteMode = NOTEMODE::MOMENTARY;
-			learnedNote = true;
+			learnMidi(false, ch);
 			learnedNoteLast = note;
-			commitLearn();
-			updateMapLen();
-			refreshParamHandleText(learningId);
 		}
-		bool midiReceived = valuesNote[note] != vel;
-		valuesNote[note] = vel;
-		valuesNoteTs[note] = ts;
+		bool midiReceived = valuesNote[MIDI_ROW_ANY][note] != vel;
+		valuesNote[ch][note] = valuesNote[MIDI_ROW_ANY][note] = vel;
+		valuesNoteTs[ch][note] = valuesNoteTs[MIDI_ROW_ANY][note] = ts;
+		mapMarkPending(noteIndex, note, ch);
 		return midiReceived;
 	}
 
 	bool midiNoteRelease(midi::Message msg) {
 		uint8_t note = msg.getNote();
-		bool midiReceived = valuesNote[note] != 0;
-		valuesNote[note] = 0;
-		valuesNoteTs[note] = ts;
+		int ch = msg.getChannel();
+		bool midiReceived = valuesNote[MIDI_ROW_ANY][note] != 0;
+		valuesNote[ch][note] = valuesNote[MIDI_ROW_ANY][note] = 0;
+		valuesNoteTs[ch][note] = valuesNoteTs[MIDI_ROW_ANY][note] = ts;
+		mapMarkPending(noteIndex, note, ch);
 		return midiReceived;
 	}
 
+	/** Commits a learned CC or note received on MIDI channel ch to the learning slot. */
+	void learnMidi(bool cc, int ch) {
+		int id = learningId;
+		if (cc) {
+			ccs[id].ccMode = CCMODE::DIRECT;
+			notes[id].setNote(-1);
+			learnedCc = true;
+		}
+		else {
+			learnedNote = true;
+		}
+		// The channel is only relevant if the input listens on all channels
+		midiChannel[id] = midiInput.channel < 0 ? ch : -1;
+		commitLearn();
+		updateMapLen();
+		refreshParamHandleText(id);
+	}
+
+	/** Marks the mappings listed for number which listen on MIDI channel ch. */
+	template<int SIZE>
+	void mapMarkPending(MapIndex<SIZE>& index, int number, int ch) {
+		for (int e = index.head[number]; e >= 0; e = index.next[e]) {
+			int id = index.mapId[e];
+			if (midiChannel[id] >= 0 && midiChannel[id] != ch) continue;
+			mapMarkPending(id);
+		}
+	}
+
+	void mapMarkPending(int id) {
+		if (mapPending[id]) return;
+		mapPending[id] = true;
+		mapPendingIds[mapPendingLen++] = id;
+	}
+
+	/** Rebuilds the CC-, NRPN- and note-index of all mappings, must be called on the engine-thread. */
+	void mapIndexUpdate() {
+		mapIndexDirty = false;
+		ccIndex.clear();
+		noteIndex.clear();
+		nrpnIndex.clear();
+		mapActiveLen = 0;
+		for (int id = MAX_CHANNELS - 1; id >= 0; id--) {
+			int cc = ccs[id].getCc();
+			int nrpn = ccs[id].getNrpn();
+			int note = notes[id].getNote();
+			if (nrpn >= 0) {
+				nrpnIndex.add(nrpn & 127, id);
+			}
+			else if (cc >= 0) {
+				ccIndex.add(cc, id);
+				if (ccs[id].get14bit() && cc + 32 < 128) ccIndex.add(cc + 32, id);
+			}
+			if (note >= 0) {
+				noteIndex.add(note, id);
+			}
+		}
+		for (int id = 0; id < MAX_CHANNELS; id++) {
+			if (ccs[id].getCc() >= 0 || notes[id].getNote() >= 0) {
+				mapActive[mapActiveLen++] = id;
+			}
+		}
+		mapProcessAll = true;
+	}
+
 	void midiResendFeedback() {
 		for (int i = 0; i < MAX_CHANNELS; i++) {
 			lastValueOut[i] = -1;
 			ccs[i].resetValue();
 			notes[i].resetValue();
 		}
+		mapProcessAll = true;
 	}
 
 	void clearMap(int id, bool midiOnly = false) {
@@ -790,6 +1206,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 		ccs[id].reset();
 		notes[id].reset();
 		midiOptions[id] = 0;
+		midiChannel[id] = -1;
 		midiParam[id].reset();
 		if (!midiOnly) {
 			textLabel[id] = "";
@@ -806,6 +1223,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 			notes[id].reset();
 			textLabel[id] = "";
 			midiOptions[id] = 0;
+			midiChannel[id] = -1;
 			midiParam[id].reset();
 			APP->engine->updateParamHandle(&paramHandles[id], -1, 0, true);
 			refreshParamHandleText(id);
@@ -821,6 +1239,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 			notes[id].reset();
 			textLabel[id] = "";
 			midiOptions[id] = 0;
+			midiChannel[id] = -1;
 			midiParam[id].reset();
 			APP->engine->updateParamHandle_NoLock(&paramHandles[id], -1, 0, true);
 			refreshParamHandleText(id);
@@ -829,6 +1248,17 @@ struct MidiCatModule : Module, StripIdFixModule {
 		expMemModuleId = -1;
 	}
 
+	int midiRow(int id) {
+		return midiChannel[id] < 0 ? MIDI_ROW_ANY : midiChannel[id];
+	}
+
+	void setMidiChannel(int id, int channel) {
+		midiChannel[id] = channel;
+		ccs[id].resetValue();
+		notes[id].resetValue();
+		refreshParamHandleText(id);
+	}
+
 	void updateMapLen() {
 		// Find last nonempty map
 		int id;
@@ -861,6 +1291,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 			notes[learningId].noteMode = notes[learningId - 1].noteMode;
 			midiOptions[learningId] = midiOptions[learningId - 1];
 			midiParam[learningId].setSlew(midiParam[learningId - 1].getSlew());
+			midiParam[learningId].ramp = midiParam[learningId - 1].ramp;
 			midiParam[learningId].setMin(midiParam[learningId - 1].getMin());
 			midiParam[learningId].setMax(midiParam[learningId - 1].getMax());
 			midiParam[learningId].clockMode = midiParam[learningId - 1].clockMode;
@@ -898,6 +1329,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 			learnedCcLast = -1;
 			learnedNote = false;
 			learnedNoteLast = -1;
+			learnedNrpnLast = -1;
 			learnedParam = false;
 			learnSingleSlot = learnSingle;
 		}
@@ -950,7 +1382,11 @@ struct MidiCatModule : Module, StripIdFixModule {
 
 	void refreshParamHandleText(int id) {
 		std::string text = "MIDI-CAT";
-		if (ccs[id].getCc() >= 0) {
+		if (ccs[id].getNrpn() >= 0) {
+			int nrpn = ccs[id].getNrpn();
+			text += nrpn >= 16384 ? string::f(" rpn%i", nrpn - 16384) : string::f(" nrpn%i", nrpn);
+		}
+		else if (ccs[id].getCc() >= 0) {
 			text += string::f(" cc%02d", ccs[id].getCc());
 		}
 		if (notes[id].getNote() >= 0) {
@@ -961,6 +1397,9 @@ struct MidiCatModule : Module, StripIdFixModule {
 			int semi = notes[id].getNote() % 12;
 			text += string::f(" note %s%d", noteNames[semi], oct);
 		}
+		if (midiChannel[id] >= 0) {
+			text += string::f(" ch%i", midiChannel[id] + 1);
+		}
 		paramHandles[id].text = text;
 	}
 
@@ -977,6 +1416,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 			p->cc = ccs[i].getCc();
 			p->ccMode = ccs[i].ccMode;
 			p->cc14bit = ccs[i].get14bit();
+			p->nrpn = ccs[i].getNrpn();
+			p->channel = midiChannel[i];
 			p->note = notes[i].getNote();
 			p->noteMode = notes[i].noteMode;
 			p->label = textLabel[i];
@@ -1017,9 +1458,10 @@ struct MidiCatModule : Module, StripIdFixModule {
 		int i = 0;
 		for (MemParam* it : map->paramMap) {
 			learnParam(i, m->id, it->paramId);
-			ccs[i].setCc(it->cc);
+			ccs[i].setCc(it->cc, it->nrpn);
 			ccs[i].ccMode = it->ccMode;
 			ccs[i].set14bit(it->cc14bit);
+			midiChannel[i] = clamp(it->channel, -1, 15);
 			notes[i].setNote(it->note);
 			notes[i].noteMode = it->noteMode;
 			textLabel[i] = it->label;
@@ -1068,6 +1510,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 			json_object_set_new(mapJ, "cc", json_integer(ccs[id].getCc()));
 			json_object_set_new(mapJ, "ccMode", json_integer((int)ccs[id].ccMode));
 			json_object_set_new(mapJ, "cc14bit", json_boolean(ccs[id].get14bit()));
+			json_object_set_new(mapJ, "nrpn", json_integer(ccs[id].getNrpn()));
+			json_object_set_new(mapJ, "channel", json_integer(midiChannel[id]));
 			json_object_set_new(mapJ, "note", json_integer(notes[id].getNote()));
 			json_object_set_new(mapJ, "noteMode", json_integer((int)notes[id].noteMode));
 			json_object_set_new(mapJ, "moduleId", json_integer(paramHandles[id].moduleId));
@@ -1075,6 +1519,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 			json_object_set_new(mapJ, "label", json_string(textLabel[id].c_str()));
 			json_object_set_new(mapJ, "midiOptions", json_integer(midiOptions[id]));
 			json_object_set_new(mapJ, "slew", json_real(midiParam[id].getSlew()));
+			json_object_set_new(mapJ, "ramp", json_boolean(midiParam[id].ramp));
 			json_object_set_new(mapJ, "min", json_real(midiParam[id].getMin()));
 			json_object_set_new(mapJ, "max", json_real(midiParam[id].getMax()));
 			json_object_set_new(mapJ, "clockMode", json_integer((int)midiParam[id].clockMode));
@@ -1084,6 +1529,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 		json_object_set_new(rootJ, "maps", mapsJ);
 
 		json_object_set_new(rootJ, "midiResendPeriodically", json_boolean(midiResendPeriodically));
+		json_object_set_new(rootJ, "midiFeedbackRate", json_real(midiFeedbackRate));
 		json_object_set_new(rootJ, "midiIgnoreDevices", json_boolean(midiIgnoreDevices));
 		json_object_set_new(rootJ, "midiInput", midiInput.toJson());
 		json_object_set_new(rootJ, "midiOutput", midiOutput.toJson());
@@ -1124,6 +1570,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 				json_t* ccJ = json_object_get(mapJ, "cc");
 				json_t* ccModeJ = json_object_get(mapJ, "ccMode");
 				json_t* cc14bitJ = json_object_get(mapJ, "cc14bit");
+				json_t* nrpnJ = json_object_get(mapJ, "nrpn");
+				json_t* channelJ = json_object_get(mapJ, "channel");
 				json_t* noteJ = json_object_get(mapJ, "note");
 				json_t* noteModeJ = json_object_get(mapJ, "noteMode");
 				json_t* moduleIdJ = json_object_get(mapJ, "moduleId");
@@ -1131,6 +1579,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 				json_t* labelJ = json_object_get(mapJ, "label");
 				json_t* midiOptionsJ = json_object_get(mapJ, "midiOptions");
 				json_t* slewJ = json_object_get(mapJ, "slew");
+				json_t* rampJ = json_object_get(mapJ, "ramp");
 				json_t* minJ = json_object_get(mapJ, "min");
 				json_t* maxJ = json_object_get(mapJ, "max");
 				json_t* clockModeJ = json_object_get(mapJ, "clockMode");
@@ -1146,9 +1595,10 @@ struct MidiCatModule : Module, StripIdFixModule {
 					APP->engine->updateParamHandle_NoLock(&paramHandles[mapIndex], -1, 0, true);
 				}
 
-				ccs[mapIndex].setCc(ccJ ? json_integer_value(ccJ) : -1);
+				ccs[mapIndex].setCc(ccJ ? json_integer_value(ccJ) : -1, nrpnJ ? json_integer_value(nrpnJ) : -1);
 				ccs[mapIndex].ccMode = (CCMODE)json_integer_value(ccModeJ);
 				if (cc14bitJ) ccs[mapIndex].set14bit(json_boolean_value(cc14bitJ));
+				midiChannel[mapIndex] = channelJ ? clamp((int)json_integer_value(channelJ), -1, 15) : -1;
 				notes[mapIndex].setNote(noteJ ? json_integer_value(noteJ) : -1);
 				notes[mapIndex].noteMode = (NOTEMODE)json_integer_value(noteModeJ);
 				midiOptions[mapIndex] = json_integer_value(midiOptionsJ);
@@ -1163,6 +1613,7 @@ struct MidiCatModule : Module, StripIdFixModule {
 				}
 				if (labelJ) textLabel[mapIndex] = json_string_value(labelJ);
 				if (slewJ) midiParam[mapIndex].setSlew(json_real_value(slewJ));
+				if (rampJ) midiParam[mapIndex].ramp = json_boolean_value(rampJ);
 				if (minJ) midiParam[mapIndex].setMin(json_real_value(minJ));
 				if (maxJ) midiParam[mapIndex].setMax(json_real_value(maxJ));
 				if (clockModeJ) midiParam[mapIndex].clockMode = (MidiCatParam::CLOCKMODE)json_integer_value(clockModeJ);
@@ -1175,6 +1626,8 @@ struct MidiCatModule : Module, StripIdFixModule {
 		
 		json_t* midiResendPeriodicallyJ = json_object_get(rootJ, "midiResendPeriodically");
 		if (midiResendPeriodicallyJ) midiResendPeriodically = json_boolean_value(midiResendPeriodicallyJ);
+		json_t* midiFeedbackRateJ = json_object_get(rootJ, "midiFeedbackRate");
+		if (midiFeedbackRateJ) midiFeedbackRate = std::max(float(json_number_value(midiFeedbackRateJ)), 0.f);
 
 		if (!midiIgnoreDevices) {
 			json_t* midiIgnoreDevicesJ = json_object_get(rootJ, "midiIgnoreDevices");
@@ -1376,7 +1829,11 @@ struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
 	}
 
 	std::string getSlotPrefix() override {
-		if (module->ccs[id].getCc() >= 0) {
+		if (module->ccs[id].getNrpn() >= 0) {
+			int nrpn = module->ccs[id].getNrpn();
+			return nrpn >= 16384 ? string::f("r%04d ", nrpn - 16384) : string::f("n%04d ", nrpn);
+		}
+		else if (module->ccs[id].getCc() >= 0) {
 			return string::f("cc%02d ", module->ccs[id].getCc());
 		}
 		else if (module->notes[id].getNote() >= 0) {
@@ -1504,10 +1961,23 @@ struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
 
 		if (module->ccs[id].getCc() >= 0 || module->notes[id].getNote() >= 0) {
 			menu->addChild(construct<UnmapMidiItem>(&MenuItem::text, "Clear MIDI assignment", &UnmapMidiItem::module, module, &UnmapMidiItem::id, id));
+			std::map<int, std::string> channelLabels;
+			channelLabels[-1] = "Any";
+			for (int c = 0; c < 16; c++) {
+				channelLabels[c] = string::f("%i", c + 1);
+			}
+			menu->addChild(StoermelderPackOne::Rack::createMapSubmenuItem<int>("MIDI channel", channelLabels,
+				[=]() {
+					return module->midiChannel[id];
+				},
+				[=](int channel) {
+					module->setMidiChannel(id, channel);
+				}
+			));
 		}
 		if (module->ccs[id].getCc() >= 0) {
 			menu->addChild(new MenuSeparator());
-			menu->addChild(construct<CcModeMenuItem>(&MenuItem::text, "Input mode for CC", &CcModeMenuItem::module, module, &CcModeMenuItem::id, id));
+			menu->addChild(construct<CcModeMenuItem>(&MenuItem::text, module->ccs[id].getNrpn() >= 0 ? "Input mode for NRPN" : "Input mode for CC", &CcModeMenuItem::module, module, &CcModeMenuItem::id, id));
 			menu->addChild(construct<Cc14bitItem>(&MenuItem::text, "14-bit", &MenuItem::disabled, module->ccs[id].getCc() > 32, &Cc14bitItem::module, module, &Cc14bitItem::id, id));
 		}
 		if (module->notes[id].getNote() >= 0) {
@@ -1598,6 +2068,7 @@ struct MidiCatChoice : MapModuleChoice<MAX_CHANNELS, MidiCatModule> {
 		}; // struct LabelMenuItem
 
 		menu->addChild(new SlewSlider(&module->midiParam[id]));
+		menu->addChild(createBoolPtrMenuItem("Ramp between values", "", &module->midiParam[id].ramp));
 		menu->addChild(construct<MenuLabel>(&MenuLabel::text, "Scaling"));
 		std::string l = string::f("Input %s", module->ccs[id].getCc() >= 0 ? "MIDI CC" : (module->notes[id].getNote() >= 0 ? "MIDI vel" : ""));
 		menu->addChild(construct<ScalingInputLabel>(&MenuLabel::text, l, &ScalingInputLabel::p, &module->midiParam[id]));
@@ -1982,6 +2453,10 @@ struct MidiCatWidget : ThemedModuleWidget<MidiCatModule>, ParamWidgetContextExte
 							if (module->textLabel[i] != "") {
 								text = module->textLabel[i];
 							}
+							else if (module->ccs[i].getNrpn() >= 0) {
+								int nrpn = module->ccs[i].getNrpn();
+								text = nrpn >= 16384 ? string::f("MIDI RPN %i", nrpn - 16384) : string::f("MIDI NRPN %i", nrpn);
+							}
 							else if (module->ccs[i].getCc() >= 0) {
 								text = string::f("MIDI CC %02d", module->ccs[i].getCc());
 							}
@@ -2205,6 +2680,15 @@ struct MidiCatWidget : ThemedModuleWidget<MidiCatModule>, ParamWidgetContextExte
 				menu->addChild(createBoolPtrMenuItem("Periodically", "", &module->midiResendPeriodically));
 			}
 		));
+		menu->addChild(StoermelderPackOne::Rack::createMapPtrSubmenuItem<float>("MIDI feedback rate", {
+				{ 0.f, "Unlimited" },
+				{ 0.5f, "0.5 messages/ms" },
+				{ 1.f, "1 message/ms (DIN MIDI)" },
+				{ 2.f, "2 messages/ms" },
+				{ 4.f, "4 messages/ms" }
+			},
+			&module->midiFeedbackRate
+		));
 		menu->addChild(createMenuItem("Import MIDI-MAP preset", "", [=]() { loadMidiMapPreset_dialog(); }));
 
 		menu->addChild(new MenuSeparator());
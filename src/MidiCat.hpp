@@ -4,7 +4,7 @@
 namespace StoermelderPackOne {
 namespace MidiCat {
 
-static const int MAX_CHANNELS = 128;
+static const int MAX_CHANNELS = 256;
 
 #define MIDIOPTION_VELZERO_BIT 0
 
@@ -34,6 +34,10 @@ struct MemParam {
 	int cc = -1;
 	CCMODE ccMode;
 	bool cc14bit = false;
+	/** NRPN parameter number, RPNs are offset by 16384, -1 for plain CCs */
+	int nrpn = -1;
+	/** MIDI channel, -1 for any channel */
+	int channel = -1;
 	int note = -1;
 	NOTEMODE noteMode;
 	std::string label;
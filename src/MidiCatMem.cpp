@@ -73,6 +73,8 @@ struct MidiCatMemModule : Module {
 				json_object_set_new(paramMapJJ, "cc", json_integer(p->cc));
 				json_object_set_new(paramMapJJ, "ccMode", json_integer((int)p->ccMode));
 				json_object_set_new(paramMapJJ, "cc14bit", json_boolean(p->cc14bit));
+				json_object_set_new(paramMapJJ, "nrpn", json_integer(p->nrpn));
+				json_object_set_new(paramMapJJ, "channel", json_integer(p->channel));
 				json_object_set_new(paramMapJJ, "note", json_integer(p->note));
 				json_object_set_new(paramMapJJ, "noteMode", json_integer((int)p->noteMode));
 				json_object_set_new(paramMapJJ, "label", json_string(p->label.c_str()));
@@ -115,6 +117,10 @@ struct MidiCatMemModule : Module {
 				p->ccMode = (CCMODE)json_integer_value(json_object_get(paramMapJJ, "ccMode"));
 				json_t* cc14bitJ = json_object_get(paramMapJJ, "cc14bit");
 				if (cc14bitJ) p->cc14bit = json_boolean_value(cc14bitJ);
+				json_t* nrpnJ = json_object_get(paramMapJJ, "nrpn");
+				if (nrpnJ) p->nrpn = json_integer_value(nrpnJ);
+				json_t* channelJ = json_object_get(paramMapJJ, "channel");
+				if (channelJ) p->channel = json_integer_value(channelJ);
 				p->note = json_integer_value(json_object_get(paramMapJJ, "note"));
 				p->noteMode = (NOTEMODE)json_integer_value(json_object_get(paramMapJJ, "noteMode"));
 				p->label = json_string_value(json_object_get(paramMapJJ, "label"));
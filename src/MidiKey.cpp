@@ -1,5 +1,6 @@
 #include "plugin.hpp"
 #include "components/MidiWidget.hpp"
+#include "helpers/MidiInputQueue.hpp"
 #include "ui/keyboard.hpp"
 #include "ui/ModuleSelectProcessor.hpp"
 #include "ui/ViewportHelper.hpp"
@@ -16,7 +17,7 @@ struct MidiKeyModule : Module {
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 	/** [Stored to Json] */
-	midi::InputQueue midiInput;
+	MidiInputQueue<> midiInput;
 
 	struct SlotData {
 		/** [Stored to Json] */
@@ -63,6 +64,7 @@ struct MidiKeyModule : Module {
 	MidiKeyModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
 		config(0, 0, 0, 0);
+		midiInput.statusMask = MidiInputQueue<>::STATUS_NOTE | MidiInputQueue<>::STATUS_CC;
 		onReset();
 	}
 
@@ -1,6 +1,7 @@
 #include "plugin.hpp"
 #include "components/LedTextDisplay.hpp"
 #include "components/MidiWidget.hpp"
+#include "helpers/MidiInputQueue.hpp"
 #include "components/LogDisplay.hpp"
 #include <osdialog.h>
 #include <iomanip>
@@ -50,7 +51,7 @@ struct MidiMonModule : Module {
 	bool showSystemMsg;
 
 	/** [Stored to JSON] */
-	midi::InputQueue midiInput;
+	MidiInputQueue<> midiInput;
 
 	dsp::RingBuffer<std::tuple<float, std::string>, 512> midiLogMessages;
 	uint64_t sample;
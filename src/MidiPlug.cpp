@@ -1,5 +1,6 @@
 #include "plugin.hpp"
 #include "components/MidiWidget.hpp"
+#include "helpers/MidiInputQueue.hpp"
 #include "components/LedDisplayCenterChoiceEx.hpp"
 #include <osdialog.h>
 
@@ -74,7 +75,7 @@ struct MidiPlugModule : Module {
 	};
 
 	/** [Stored to Json] */
-	midi::InputQueue midiInput[INPUT];
+	MidiInputQueue<> midiInput[INPUT];
 	/** [Stored to Json] */
 	MidiPlugOutput midiOutput[OUTPUT];
 
@@ -1,5 +1,6 @@
 #include "plugin.hpp"
 #include "components/MidiWidget.hpp"
+#include "helpers/MidiInputQueue.hpp"
 
 namespace StoermelderPackOne {
 namespace MidiStep {
@@ -35,7 +36,7 @@ struct MidiStepModule : Module {
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 	/** [Stored to JSON] */
-	midi::InputQueue midiInput;
+	MidiInputQueue<> midiInput;
 	/** [Stored to JSON] */
 	MODE mode = MODE::BEATSTEP_R1;
 	/** [Stored to JSON] */
@@ -56,6 +57,7 @@ struct MidiStepModule : Module {
 	MidiStepModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		midiInput.statusMask = MidiInputQueue<>::STATUS_CC;
 		for (int i = 0; i < PORTS; i++) {
 			configOutput(OUTPUT_DEC + i, string::f("Decrement %i trigger", i + 1));
 			configOutput(OUTPUT_INC + i, string::f("Increment %i trigger", i + 1));
@@ -1,6 +1,7 @@
 #include "plugin.hpp"
 #include "helpers/StripIdFixModule.hpp"
 #include "helpers/TaskProcessor.hpp"
+#include "helpers/ResolvedParam.hpp"
 #include <plugin.hpp>
 
 namespace StoermelderPackOne {
@@ -48,6 +49,9 @@ struct MirrorModule : Module, StripIdFixModule {
 	std::vector<ParamHandle*> sourceHandles;
 	/** [Stored to JSON] */
 	std::vector<ParamHandle*> targetHandles;
+	/** Resolution of sourceHandles and targetHandles, used by the engine-thread only */
+	std::vector<ResolvedParam> sourceResolved;
+	std::vector<ResolvedParam> targetResolved;
 	/** [Stored to JSON] */
 	int cvParamId[8];
 
@@ -134,40 +138,42 @@ struct MirrorModule : Module, StripIdFixModule {
 				sourceHandle->color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0x40, 0xff, 0xff);
 
 				size_t j = i;
-				std::list<std::function<void()>> handleList;
+				bool unmap = false;
 				while (j < targetHandles.size()) {
 					ParamHandle* targetHandle = targetHandles[j];
 					targetHandle->color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0xff, 0x40, 0xff);
-					if (sourceHandle->moduleId < 0 && targetHandle->moduleId >= 0) {
-						// Unmap target parameter
-						// This might cause a deadlock as the engine's mutex could already be locked
-						handleList.push_back([targetHandle]() {
-							APP->engine->updateParamHandle(targetHandle, -1, 0, true);
-						});
-					}
-
+					unmap = unmap || (sourceHandle->moduleId < 0 && targetHandle->moduleId >= 0);
 					j += sourceHandles.size();
 				}
 
 				// Enqueue on the UI-thread for cleaning up ParamHandles
-				if (handleList.size() > 0) {
-					taskProcessorUi.enqueue([handleList]() {
-						for (std::function<void()> f : handleList) f();
+				// Unmapping here might cause a deadlock as the engine's mutex could already be locked
+				if (unmap) {
+					taskProcessorUi.enqueue([this, i]() {
+						if (i >= sourceHandles.size() || sourceHandles[i]->moduleId >= 0) return;
+						for (size_t j = i; j < targetHandles.size(); j += sourceHandles.size()) {
+							if (targetHandles[j]->moduleId >= 0) {
+								APP->engine->updateParamHandle(targetHandles[j], -1, 0, true);
+							}
+						}
 					});
 				}
 			}
 		}
 
 		if (audioRate || processDivider.process()) {
+			// Entries are looked up on every call, so shifted indices do no harm
+			if (sourceResolved.size() != sourceHandles.size()) sourceResolved.resize(sourceHandles.size());
+			if (targetResolved.size() != targetHandles.size()) targetResolved.resize(targetHandles.size());
+
 			for (int i = 0; i < 8; i++) {
 				if (cvParamId[i] >= 0 && inputs[INPUT_CV + i].isConnected()) {
 					float v = clamp(inputs[INPUT_CV + i].getVoltage(), 0.f, 10.f);
-					ParamHandle* sourceHandle = sourceHandles[cvParamId[i]];
-					ParamQuantity* sourceParamQuantity = getParamQuantity(sourceHandle);
-					if (sourceParamQuantity) {
+					ResolvedParam* source = &sourceResolved[cvParamId[i]];
+					if (source->resolve(sourceHandles[cvParamId[i]])) {
 						//sourceParamQuantity->setScaledValue(v / 10.f);
-						float vScaled = math::rescale(v / 10.f, 0.f, 1.f, sourceParamQuantity->getMinValue(), sourceParamQuantity->getMaxValue());
-						sourceParamQuantity->getParam()->setValue(vScaled);
+						float vScaled = math::rescale(v / 10.f, 0.f, 1.f, source->minValue, source->maxValue);
+						source->param->setValue(vScaled);
 					}
 					else {
 						cvParamId[i] = -1;
@@ -175,19 +181,19 @@ struct MirrorModule : Module, StripIdFixModule {
 				}
 			}
 
-			for (ParamHandle* sourceHandle : sourceHandles) {
-				ParamQuantity* sourceParamQuantity = getParamQuantity(sourceHandle);
-				if (!sourceParamQuantity) continue;
+			for (size_t k = 0; k < sourceHandles.size(); k++) {
+				ParamHandle* sourceHandle = sourceHandles[k];
+				ResolvedParam* source = &sourceResolved[k];
+				if (!source->resolve(sourceHandle)) continue;
 
-				float v = sourceParamQuantity->getValue();
+				float v = source->param->getValue();
 
 				int i = sourceHandle->paramId;
 				while (i < (int)targetHandles.size()) {
-					ParamHandle* targetHandle = targetHandles[i];
-					ParamQuantity* targetParamQuantity = getParamQuantity(targetHandle);
-					if (targetParamQuantity) {
+					ResolvedParam* target = &targetResolved[i];
+					if (target->resolve(targetHandles[i])) {
 						//targetParamQuantity->setValue(v);
-						targetParamQuantity->getParam()->setValue(v);
+						target->param->setValue(v);
 					}
 					i += sourceHandles.size();
 				}
@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "digital.hpp"
 #include "components/Knobs.hpp"
 
 namespace StoermelderPackOne {
@@ -37,6 +38,11 @@ enum class DISTRIBUTION {
 	UNIFORM = 2
 };
 
+enum class PANLAW {
+	LINEAR = 0,
+	EQUAL_POWER = 1
+};
+
 struct OrbitModule : Module {
 	enum ParamIds {
 		PARAM_SPREAD,
@@ -67,11 +73,14 @@ struct OrbitModule : Module {
 	bool polyOut;
 	/** [Stored to JSON] */
 	DISTRIBUTION dist;
+	/** [Stored to JSON] */
+	PANLAW panLaw;
 
-	float pan[PORT_MAX_CHANNELS];
-	dsp::SchmittTrigger trigger[PORT_MAX_CHANNELS];
-	dsp::ExponentialFilter clickFilter[PORT_MAX_CHANNELS];
-	LinearDrift<float> linearDrift[PORT_MAX_CHANNELS];
+	simd::float_4 pan[PORT_MAX_CHANNELS / 4];
+	dsp::TSchmittTrigger<simd::float_4> trigger[PORT_MAX_CHANNELS / 4];
+	dsp::TExponentialFilter<simd::float_4> clickFilter[PORT_MAX_CHANNELS / 4];
+	LinearDrift<simd::float_4> linearDrift[PORT_MAX_CHANNELS / 4];
+	Xorshift128_4 rng;
 
 	OrbitModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
@@ -96,10 +105,11 @@ struct OrbitModule : Module {
 	void onReset() override {
 		polyOut = false;
 		dist = DISTRIBUTION::NORMAL;
-		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
-			pan[c] = 0.5f;
-			clickFilter[c].setTau(0.005f);
-			linearDrift[c].setMinCenterMax(0.f, 0.5, 1.f);
+		panLaw = PANLAW::LINEAR;
+		for (int c = 0; c < PORT_MAX_CHANNELS; c += 4) {
+			pan[c / 4] = 0.5f;
+			clickFilter[c / 4].setTau(0.005f);
+			linearDrift[c / 4].setMinCenterMax(0.f, 0.5f, 1.f);
 		}
 		Module::onReset();
 	}
@@ -108,43 +118,46 @@ struct OrbitModule : Module {
 		int channels = inputs[INPUT_IN].getChannels();
 		float drift = params[PARAM_DRIFT].getValue();
 		float level = std::pow(params[PARAM_LEVEL].getValue(), 2.f);
+		float spread = inputs[INPUT_SPREAD].getNormalVoltage(10.f) / 10.f * params[PARAM_SPREAD].getValue();
+
+		alignas(16) float outL[PORT_MAX_CHANNELS];
+		alignas(16) float outR[PORT_MAX_CHANNELS];
+		simd::float_4 sumL = 0.f;
+		simd::float_4 sumR = 0.f;
+
+		for (int c = 0; c < channels; c += 4) {
+			linearDrift[c / 4].setDrift(drift);
 
-		float outL[PORT_MAX_CHANNELS];
-		float sumL = 0.f;
-		float outR[PORT_MAX_CHANNELS];
-		float sumR = 0.f;
-
-		for (int c = 0; c < channels; c++) {
-			linearDrift[c].setDrift(drift);
-
-			if (trigger[c].process(inputs[INPUT_TRIG].getPolyVoltage(c))) {
-				float spread = inputs[INPUT_SPREAD].getNormalVoltage(10.f) / 10.f * params[PARAM_SPREAD].getValue();
-				float p = 0.5f; // position between 0 and 1, 0.5 is center
-				switch (dist) {
-					case DISTRIBUTION::EXTERNAL:
-						p = inputs[INPUT_DIST].getPolyVoltage(c) / 10.f + 0.5f;
-						break;
-					case DISTRIBUTION::NORMAL:
-						p = random::normal() / 6.f + 0.5f;
-						break;
-					case DISTRIBUTION::NORMAL_MIRROR:
-						p = random::normal();
-						p = (3.f * sgn(-p) + p) / 6.f + 0.5f;
-						break;
-					case DISTRIBUTION::UNIFORM:
-						p = random::uniform();
-						break;
-				}
-				pan[c] = clamp(p * spread, 0.f, 1.f);
+			simd::float_4 t = trigger[c / 4].process(inputs[INPUT_TRIG].getPolyVoltageSimd<simd::float_4>(c));
+			if (simd::movemask(t)) {
+				// position between 0 and 1, 0.5 is center
+				simd::float_4 p = distribution(c);
+				pan[c / 4] = simd::ifelse(t, simd::clamp(p * spread, 0.f, 1.f), pan[c / 4]);
 			}
 
-			pan[c] = linearDrift[c].process(args.sampleTime, pan[c]);
-			float p = clickFilter[c].process(args.sampleTime, pan[c]);
-			float v = inputs[INPUT_IN].getVoltage(c);
-			outL[c] = p * v * level;
-			sumL += outL[c];
-			outR[c] = (1.f - p) * v * level;
-			sumR += outR[c];
+			pan[c / 4] = linearDrift[c / 4].process(args.sampleTime, pan[c / 4]);
+			simd::float_4 p = clickFilter[c / 4].process(args.sampleTime, pan[c / 4]);
+			simd::float_4 gL, gR;
+			switch (panLaw) {
+				default:
+					gL = p;
+					gR = 1.f - p;
+					break;
+				case PANLAW::EQUAL_POWER:
+					gL = simd::sin(p * float(M_PI / 2.0));
+					gR = simd::cos(p * float(M_PI / 2.0));
+					break;
+			}
+
+			simd::float_4 v = inputs[INPUT_IN].getVoltageSimd<simd::float_4>(c) * level;
+			// Lanes above the number of channels are excluded from the sums
+			simd::float_4 lanes = simd::float_4(c, c + 1, c + 2, c + 3) < float(channels);
+			simd::float_4 l = simd::ifelse(lanes, gL * v, 0.f);
+			simd::float_4 r = simd::ifelse(lanes, gR * v, 0.f);
+			l.store(&outL[c]);
+			r.store(&outR[c]);
+			sumL += l;
+			sumR += r;
 		}
 
 		if (polyOut) {
@@ -155,17 +168,45 @@ struct OrbitModule : Module {
 		}
 		else {
 			outputs[OUTPUT_L].setChannels(1);
-			outputs[OUTPUT_L].setVoltage(sumL);
+			outputs[OUTPUT_L].setVoltage(sumL[0] + sumL[1] + sumL[2] + sumL[3]);
 			outputs[OUTPUT_R].setChannels(1);
-			outputs[OUTPUT_R].setVoltage(sumR);
+			outputs[OUTPUT_R].setVoltage(sumR[0] + sumR[1] + sumR[2] + sumR[3]);
 		}
 	}
 
+	/** Random positions for channels c..c+3 */
+	inline simd::float_4 distribution(int c) {
+		switch (dist) {
+			case DISTRIBUTION::EXTERNAL: {
+				return inputs[INPUT_DIST].getPolyVoltageSimd<simd::float_4>(c) / 10.f + 0.5f;
+			}
+			case DISTRIBUTION::NORMAL: {
+				return normal() / 6.f + 0.5f;
+			}
+			case DISTRIBUTION::NORMAL_MIRROR: {
+				simd::float_4 p = normal();
+				return (3.f * simd::sgn(-p) + p) / 6.f + 0.5f;
+			}
+			case DISTRIBUTION::UNIFORM: {
+				return rng.uniform();
+			}
+		}
+		return 0.5f;
+	}
+
+	/** Standard normal distribution by the Box-Muller transform */
+	inline simd::float_4 normal() {
+		simd::float_4 u1 = rng.uniform();
+		simd::float_4 u2 = rng.uniform();
+		return simd::sqrt(-2.f * simd::log(u1)) * simd::cos(2.f * float(M_PI) * u2);
+	}
+
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
 		json_object_set_new(rootJ, "polyOut", json_boolean(polyOut));
 		json_object_set_new(rootJ, "dist", json_integer((int)dist));
+		json_object_set_new(rootJ, "panLaw", json_integer((int)panLaw));
 		return rootJ;
 	}
 
@@ -173,6 +214,7 @@ struct OrbitModule : Module {
 		panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
 		polyOut = json_boolean_value(json_object_get(rootJ, "polyOut"));
 		dist = (DISTRIBUTION)json_integer_value(json_object_get(rootJ, "dist"));
+		panLaw = (PANLAW)json_integer_value(json_object_get(rootJ, "panLaw"));
 	}
 };
 
@@ -211,6 +253,13 @@ struct OrbitWidget : ThemedModuleWidget<OrbitModule> {
 			},
 			&module->dist
 		));
+		menu->addChild(StoermelderPackOne::Rack::createMapPtrSubmenuItem("Pan law",
+			{
+				{ PANLAW::LINEAR, "Linear" },
+				{ PANLAW::EQUAL_POWER, "Equal-power" }
+			},
+			&module->panLaw
+		));
 		menu->addChild(createBoolPtrMenuItem("Polyphonic output", "", &module->polyOut));
 	}
 };
@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "digital.hpp"
 #include "components/Knobs.hpp"
 
 /**
@@ -53,16 +54,39 @@ struct RawModule : Module {
 		NUM_LIGHTS
 	};
 
+	enum COEFS {
+		COEF_A1,
+		COEF_A2,
+		COEF_A3,
+		COEF_K3,
+		COEF_GAIN_IN,
+		COEF_GAIN_OUT,
+		NUM_COEFS
+	};
+
+	static const int QUALITY = 8;
+
 	alignas(16) simd::float_4 y[4][2];
 	alignas(16) simd::float_4 x[4][3];
 	float Ts, Ts0001;
 	float A1, A2, A3;
 	float m, c, k, k3, Fn, Wn, in_gain, out_gain;
+	/** Coefficients used for processing, ramped linearly to the values of prepareParameters() within one block */
+	float coef[NUM_COEFS];
+	float coefStep[NUM_COEFS];
+
+	Upsampler4<2, QUALITY> upsampler2[4];
+	Decimator4<2, QUALITY> decimator2[4];
+	Upsampler4<4, QUALITY> upsampler4[4];
+	Decimator4<4, QUALITY> decimator4[4];
 
 	dsp::ClockDivider paramDivider;
 
 	/** [Stored to JSON] */
 	int panelTheme = 0;
+	/** [Stored to JSON] */
+	int oversample = 1;
+	int oversampleCurrent = 1;
 
 	RawModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
@@ -81,16 +105,28 @@ struct RawModule : Module {
 
 	void onReset() override {
 		Module::onReset();
+		stateReset();
+		prepareParameters(true);
+		paramDivider.reset();
+	}
+
+	void onSampleRateChange() override {
+		prepareParameters(true);
+	}
+
+	void stateReset() {
 		for (int c = 0; c < 16; c += 4) {
 			y[c / 4][0] = y[c / 4][1] = 0.f;
 			x[c / 4][0] = x[c / 4][1] = x[c / 4][2] = 0.f;
+			upsampler2[c / 4].reset();
+			decimator2[c / 4].reset();
+			upsampler4[c / 4].reset();
+			decimator4[c / 4].reset();
 		}
-		prepareParameters();
-		Ts0001 = 0.2267f;
-		paramDivider.reset();
 	}
 
-	void prepareParameters() {
+	/** Computes the coefficients for the current parameters, immediately or as target for the ramps of the next block. */
+	void prepareParameters(bool immediate = false) {
 		in_gain = pow(10.f, params[PARAM_GAIN_IN].getValue() / 20.f);
 		// for normalization of input voltage [-5V,5V] to [-1,1]
 		in_gain /= 5.0f;
@@ -102,7 +138,7 @@ struct RawModule : Module {
 		// for normalization of [-1,1] to output voltage [-5V,5V]
 		out_gain *= 5.0f; 
 
-		Ts = APP->engine->getSampleTime();
+		Ts = APP->engine->getSampleTime() / oversampleCurrent;
 		Ts0001 = Ts / 0.0001f;
 
 		// scale damping with frequency and nonlinearity to preserve stability
@@ -118,36 +154,86 @@ struct RawModule : Module {
 		A1 = m / pow(Ts, 2) + c / Ts;
 		A2 = (-2 * m) / pow(Ts, 2) - c / Ts - k;
 		A3 = m / pow(Ts, 2);
+
+		float target[NUM_COEFS] = { A1, A2, A3, k3, in_gain, out_gain };
+		for (int i = 0; i < NUM_COEFS; i++) {
+			if (immediate) coef[i] = target[i];
+			coefStep[i] = (target[i] - coef[i]) / paramDivider.getDivision();
+		}
+	}
+
+	/** One step of the displacement equation for channels c..c+3, returns the velocity */
+	inline simd::float_4 processResonator(int c, simd::float_4 in, float A1inv, float Ts0001inv) {
+		y[c / 4][0] = in;
+
+		// displacement equation
+		simd::float_4 x1 = x[c / 4][1];
+		x[c / 4][0] = (y[c / 4][1] - coef[COEF_A2] * x1 - coef[COEF_A3] * x[c / 4][2] - coef[COEF_K3] * (x1 * x1 * x1)) * A1inv;
+
+		// velocity (normalized by 10000)
+		simd::float_4 v = (x[c / 4][0] - x1) * Ts0001inv;
+
+		// safety net for extreme settings, oversampling keeps the system stable on high frequencies
+		simd::float_4 b = simd::abs(v) > 100.f;
+		x[c / 4][0] = simd::ifelse(b, 0.f, x[c / 4][0]);
+		x[c / 4][1] = simd::ifelse(b, 0.f, x[c / 4][1]);
+
+		// shift buffers
+		y[c / 4][1] = y[c / 4][0];
+		x[c / 4][2] = x[c / 4][1];
+		x[c / 4][1] = x[c / 4][0];
+		return v;
 	}
 
 	void process(const ProcessArgs& args) override {
 		int channels = inputs[INPUT].getChannels();
 
+		if (oversample != oversampleCurrent) {
+			oversampleCurrent = oversample;
+			stateReset();
+			prepareParameters(true);
+			paramDivider.reset();
+		}
 		if (paramDivider.process()) {
 			prepareParameters();
 		}
+		for (int i = 0; i < NUM_COEFS; i++) {
+			coef[i] += coefStep[i];
+		}
 
-		for (int c = 0; c < channels; c += 4) {
-			y[c / 4][0] = inputs[INPUT].getPolyVoltageSimd<simd::float_4>(c) * in_gain;
-
-			// displacement equation
-			x[c / 4][0] = (y[c / 4][1] - A2 * x[c / 4][1] - A3 * x[c / 4][2] - k3 * pow(x[c / 4][1], 3.f)) / A1;
-
-			// velocity (normalized by 10000)
-			simd::float_4 v = (x[c / 4][0] - x[c / 4][1]) / Ts0001;
-
-			// the implementation behaves unstable in rare cases, so do some stupid "limiting"
-			// could possibly fixed with some oversampling, tbd
-			simd::float_4 b = simd::abs(v) > 100.f;
-			x[c / 4][0] = simd::ifelse(b, 0.f, x[c / 4][0]);
-			x[c / 4][1] = simd::ifelse(b, 0.f, x[c / 4][1]);
+		float A1inv = 1.f / coef[COEF_A1];
+		float Ts0001inv = 1.f / Ts0001;
 
-			// shift buffers
-			y[c / 4][1] = y[c / 4][0];
-			x[c / 4][2] = x[c / 4][1];
-			x[c / 4][1] = x[c / 4][0];
+		for (int c = 0; c < channels; c += 4) {
+			simd::float_4 in = inputs[INPUT].getPolyVoltageSimd<simd::float_4>(c) * coef[COEF_GAIN_IN];
+			simd::float_4 v;
+
+			switch (oversampleCurrent) {
+				default: {
+					v = processResonator(c, in, A1inv, Ts0001inv);
+					break;
+				}
+				case 2: {
+					simd::float_4 buffer[2];
+					upsampler2[c / 4].process(in, buffer);
+					for (int i = 0; i < 2; i++) {
+						buffer[i] = processResonator(c, buffer[i], A1inv, Ts0001inv);
+					}
+					v = decimator2[c / 4].process(buffer);
+					break;
+				}
+				case 4: {
+					simd::float_4 buffer[4];
+					upsampler4[c / 4].process(in, buffer);
+					for (int i = 0; i < 4; i++) {
+						buffer[i] = processResonator(c, buffer[i], A1inv, Ts0001inv);
+					}
+					v = decimator4[c / 4].process(buffer);
+					break;
+				}
+			}
 
-			outputs[OUTPUT].setVoltageSimd(v * out_gain, c);
+			outputs[OUTPUT].setVoltageSimd(v * coef[COEF_GAIN_OUT], c);
 		}
 
 		outputs[OUTPUT].setChannels(channels);
@@ -156,11 +242,15 @@ struct RawModule : Module {
 	json_t* dataToJson() override {
 		json_t *rootJ = json_object();
 		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
+		json_object_set_new(rootJ, "oversample", json_integer(oversample));
 		return rootJ;
 	}
 
 	void dataFromJson(json_t* rootJ) override {
 		panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
+		json_t* oversampleJ = json_object_get(rootJ, "oversample");
+		if (oversampleJ) oversample = json_integer_value(oversampleJ);
+		if (oversample != 2 && oversample != 4) oversample = 1;
 	}
 };
 
@@ -249,6 +339,16 @@ struct RawWidget : ThemedModuleWidget<RawModule> {
 		menu->addChild(p2);
 		menu->addChild(p3);
 		menu->addChild(p4);
+
+		menu->addChild(new MenuSeparator);
+		menu->addChild(StoermelderPackOne::Rack::createMapPtrSubmenuItem("Oversampling",
+			{
+				{ 1, "Off" },
+				{ 2, "2x" },
+				{ 4, "4x" }
+			},
+			&module->oversample
+		));
 	}
 };
 
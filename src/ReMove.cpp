@@ -488,6 +488,8 @@ struct ReMoveModule : MapModuleBase<1> {
         if (paramQuantity) {
             //paramQuantity->setScaledValue(v);
             float vScaled = math::rescale(v, 0.f, 1.f, paramQuantity->getMinValue(), paramQuantity->getMaxValue());
+            // Same as ParamQuantity::setValue, also absorbs the quantization of stored sequences
+            if (paramQuantity->snapEnabled) vScaled = std::round(vScaled);
             paramQuantity->getParam()->setValue(vScaled);
         }
         switch (outCvMode) {
@@ -623,6 +625,100 @@ struct ReMoveModule : MapModuleBase<1> {
         MapModuleBase::enableLearn(id);
     }
 
+    /**
+     * Encodes a sequence as base64-string, much more compact than an array of reals: Values are
+     * quantized to 16 bit and stored as differences to the previous value. The data consists of
+     * spans, each starting with a varint (n << 1 | flag): flag 0 repeats the previous value n times,
+     * flag 1 is followed by n zigzag-varint differences, one byte each for slow movements.
+     */
+    std::string seqDataEncode(int i) {
+        int s = REMOVE_MAX_DATA / seqCount;
+        float* d = &seqData[i * s];
+        int l = seqLength[i];
+        std::vector<uint8_t> bin;
+        bin.reserve(l * 2);
+        auto pushVarint = [&](uint32_t n) {
+            for (; n >= 0x80; n >>= 7) bin.push_back((n & 0x7f) | 0x80);
+            bin.push_back(n);
+        };
+        auto quantize = [&](int idx) {
+            return (int32_t)std::round(clamp(d[idx], 0.f, 1.f) * 65535.f);
+        };
+
+        int32_t last = 0;
+        int j = 0;
+        while (j < l) {
+            // Runs shorter than 4 values are cheaper as part of a literal span
+            int r = 0;
+            while (j + r < l && quantize(j + r) == last) r++;
+            if (r >= 4) {
+                pushVarint(r << 1);
+                j += r;
+                continue;
+            }
+            int k = j;
+            for (int repeats = 0; k < l; k++) {
+                repeats = quantize(k) == (k > j ? quantize(k - 1) : last) ? repeats + 1 : 0;
+                if (repeats >= 4) {
+                    k -= 3;
+                    break;
+                }
+            }
+            pushVarint((k - j) << 1 | 1);
+            for (; j < k; j++) {
+                int32_t q = quantize(j);
+                int32_t delta = q - last;
+                pushVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+                last = q;
+            }
+        }
+        return string::toBase64(bin);
+    }
+
+    void seqDataDecode(int i, const char* str) {
+        if (!str) return;
+        std::vector<uint8_t> bin;
+        try {
+            bin = string::fromBase64(str);
+        }
+        catch (std::exception& e) {
+            WARN("ReMove: could not decode sequence %i: %s", i + 1, e.what());
+            return;
+        }
+        int s = REMOVE_MAX_DATA / seqCount;
+        float* d = &seqData[i * s];
+        int l = std::min(seqLength[i], s);
+        size_t p = 0;
+        auto popVarint = [&]() {
+            uint32_t n = 0;
+            for (int shift = 0; p < bin.size() && shift < 32; shift += 7) {
+                uint8_t b = bin[p++];
+                n |= uint32_t(b & 0x7f) << shift;
+                if (!(b & 0x80)) break;
+            }
+            return n;
+        };
+
+        int32_t last = 0;
+        int c = 0;
+        while (p < bin.size() && c < l) {
+            uint32_t h = popVarint();
+            uint32_t n = h >> 1;
+            for (uint32_t k = 0; k < n && c < l; k++) {
+                if (h & 1) {
+                    if (p >= bin.size()) break;
+                    uint32_t z = popVarint();
+                    last = clamp(last + (int32_t)((z >> 1) ^ -(z & 1)), 0, 65535);
+                }
+                d[c++] = last / 65535.f;
+            }
+        }
+        // Truncated data holds the last value
+        for (; c < l; c++) {
+            d[c] = last / 65535.f;
+        }
+    }
+
     json_t *dataToJson() override {
         json_t *rootJ = MapModuleBase::dataToJson();
         json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
@@ -630,30 +726,11 @@ struct ReMoveModule : MapModuleBase<1> {
 
         json_t *rec0J = json_object();
 
-        int s = REMOVE_MAX_DATA / seqCount;
         json_t *seqDataJ = json_array();
         for (int i = 0; i < seqCount; i++) {
-            json_t *seqData1J = json_array();
-            float last1 = 100.f, last2 = -100.f;
-            for (int j = 0; j < seqLength[i]; j++) {
-                if (last1 == last2) {
-                    // 2 times same value -> compress!
-                    int c = 0;
-                    while (seqData[i * s + j] == last1 && j < seqLength[i]) { c++; j++; }
-                    json_array_append_new(seqData1J, json_integer(c));
-                    if (j < seqLength[i]) json_array_append_new(seqData1J, json_real(seqData[i * s + j]));
-                    last2 = -100.f;
-                    last1 = seqData[i * s + j];
-                } 
-                else {
-                    json_array_append_new(seqData1J, json_real(seqData[i * s + j]));
-                    last2 = last1;
-                    last1 = seqData[i * s + j];
-                }
-            }
-            json_array_append_new(seqDataJ, seqData1J);
+            json_array_append_new(seqDataJ, json_string(seqDataEncode(i).c_str()));
         }
-        json_object_set_new(rec0J, "seqData", seqDataJ);
+        json_object_set_new(rec0J, "seqData16", seqDataJ);
 
         json_t *seqLengthJ = json_array();
         for (int i = 0; i < seqCount; i++) {
@@ -729,8 +806,18 @@ struct ReMoveModule : MapModuleBase<1> {
         }
 
         int s = REMOVE_MAX_DATA / seqCount;
+        json_t *seqData16J = json_object_get(rec0J, "seqData16");
         json_t *seqDataJ = json_object_get(rec0J, "seqData");
-        if (seqDataJ) {
+        if (seqData16J) {
+            json_t *d;
+            size_t i;
+            json_array_foreach(seqData16J, i, d) {
+                if ((int)i >= seqCount) continue;
+                seqDataDecode(i, json_string_value(d));
+            }
+        }
+        else if (seqDataJ) {
+            // Patches saved with older versions store the data as array of reals
             json_t *seqData1J, *d;
             size_t i;
             json_array_foreach(seqDataJ, i, seqData1J) {
@@ -33,29 +33,30 @@ struct SipoModule : Module {
 	/** [Stored to JSON] */
 	int panelTheme = 0;
 
-	/** [Stored to JSON] */
+	/** [Stored to JSON] One register of MAX_DATA cells for each channel of the SRC-port */
 	float* data;
-	/** [Stored to JSON] */
-	int dataPtr = 0;
-	int dataUsed = 0;
+	/** [Stored to JSON] Number of cells used in each register, power of two */
+	int depth;
+	int dataPtr[PORT_MAX_CHANNELS];
+	int dataUsed[PORT_MAX_CHANNELS];
 
-	dsp::SchmittTrigger clockTrigger;
+	dsp::SchmittTrigger clockTrigger[PORT_MAX_CHANNELS];
 	dsp::ClockDivider lightDivider;
 
 	SipoModule() {
 		panelTheme = pluginSettings.panelThemeDefault;
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 		configInput(TRIG_INPUT, "Trigger");
-		inputInfos[TRIG_INPUT]->description = "Samples the input signal and stores it to the register.";
+		inputInfos[TRIG_INPUT]->description = "Samples the input signal and stores it to the register.\nA polyphonic trigger clocks each register independently.";
 		configInput(SKIP_INPUT, "Skip CV");
 		configParam(SKIP_PARAM, 0.f, MAX_DATA_32 - 1, 0.f, "Skipped register cells for the output.\nA value x means register cell x is the voltage on output channel 1.\nA value of 0 acts as a standard shift register.");
 		configInput(INCR_INPUT, "Increment CV");
 		configParam(INCR_PARAM, 0.f, MAX_DATA_32_16, 0.f, "Increment between output register cells.\nA value of y means output channel 2 is y register cells behind channel 1.\nA value of 0 acts as standard shift register.");
 		configInput(SRC_INPUT, "Shift register");
-		inputInfos[SRC_INPUT]->description = "Monophonic.";
+		inputInfos[SRC_INPUT]->description = "Monophonic: one register, the output carries 16 cells.\nPolyphonic: one register for each channel, the output carries one cell of each register.";
 		configOutput(POLY_OUTPUT, "Polyphonic");
 
-		data = new float[MAX_DATA];
+		data = new float[PORT_MAX_CHANNELS * MAX_DATA];
 		onReset();
 		lightDivider.setDivision(512);
 	}
@@ -65,29 +66,50 @@ struct SipoModule : Module {
 	}
 
 	void onReset() override {
-		dataPtr = 0;
-		dataUsed = 0;
+		depth = MAX_DATA;
+		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+			registerClear(c);
+		}
+	}
+
+	void registerClear(int c) {
+		dataPtr[c] = 0;
+		dataUsed[c] = 0;
 		for (int i = 0; i < MAX_DATA; i++) {
-			data[i] = 0.f;
+			data[c * MAX_DATA + i] = 0.f;
 		}
 	}
 
 	void process(const ProcessArgs &args) override {
-		outputs[POLY_OUTPUT].setChannels(PORT_MAX_CHANNELS);
+		// depth is a power of two, so indices wrap by masking
+		int mask = depth - 1;
+		int registers = std::max(inputs[SRC_INPUT].getChannels(), 1);
 
-		if (clockTrigger.process(inputs[TRIG_INPUT].getVoltage())) {
-			dataPtr = (dataPtr + 1) % MAX_DATA;
-			dataUsed = std::min(dataUsed + 1, MAX_DATA);
-			data[dataPtr] = inputs[SRC_INPUT].getVoltage();
+		for (int c = 0; c < registers; c++) {
+			if (clockTrigger[c].process(inputs[TRIG_INPUT].getPolyVoltage(c))) {
+				dataPtr[c] = (dataPtr[c] + 1) & mask;
+				dataUsed[c] = std::min(dataUsed[c] + 1, depth);
+				data[c * MAX_DATA + dataPtr[c]] = inputs[SRC_INPUT].getVoltage(c);
+			}
 		}
 
 		int skipCv = std::round(rescale(inputs[SKIP_INPUT].getVoltage(), 0.f, 10.f, 0, MAX_DATA_32 - 1));
-		int skip = 1 + (int)clamp((int)params[SKIP_PARAM].getValue() + skipCv, 0, MAX_DATA_32 - 1);
+		// Number of cells behind the most recent one, 0 taps the most recent cell
+		int skip = (int)clamp((int)params[SKIP_PARAM].getValue() + skipCv, 0, MAX_DATA_32 - 1);
 		int incrCv = std::round(rescale(inputs[INCR_INPUT].getVoltage(), 0.f, 10.f, 0, MAX_DATA_32_16));
 		int incr = (int)clamp((int)params[INCR_PARAM].getValue() + incrCv, 0, MAX_DATA_32_16);
 
-		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
-			outputs[POLY_OUTPUT].setVoltage(data[(dataPtr - (skip + incr * c) * c + MAX_DATA) % MAX_DATA], c);
+		if (registers == 1) {
+			outputs[POLY_OUTPUT].setChannels(PORT_MAX_CHANNELS);
+			for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+				outputs[POLY_OUTPUT].setVoltage(data[(dataPtr[0] - (skip + 1 + incr * c) * c) & mask], c);
+			}
+		}
+		else {
+			outputs[POLY_OUTPUT].setChannels(registers);
+			for (int c = 0; c < registers; c++) {
+				outputs[POLY_OUTPUT].setVoltage(data[c * MAX_DATA + ((dataPtr[c] - (skip + incr * c)) & mask)], c);
+			}
 		}
 
 		// Set channel lights infrequently
@@ -100,35 +122,93 @@ struct SipoModule : Module {
 		}
 	}
 
+	/** Used cells of a register from the oldest to the most recent one as little-endian float32, base64-encoded. */
+	std::string registerEncode(int c) {
+		int mask = depth - 1;
+		int n = std::min(dataUsed[c], depth);
+		std::vector<uint8_t> bin;
+		bin.reserve(n * 4);
+		for (int i = n - 1; i >= 0; i--) {
+			uint32_t v;
+			std::memcpy(&v, &data[c * MAX_DATA + ((dataPtr[c] - i) & mask)], sizeof(v));
+			for (int k = 0; k < 4; k++) {
+				bin.push_back((v >> (k * 8)) & 0xff);
+			}
+		}
+		return string::toBase64(bin);
+	}
+
+	void registerDecode(int c, const char* str) {
+		registerClear(c);
+		if (!str) return;
+		std::vector<uint8_t> bin;
+		try {
+			bin = string::fromBase64(str);
+		}
+		catch (std::exception& e) {
+			WARN("Sipo: could not decode register %i: %s", c + 1, e.what());
+			return;
+		}
+		int n = std::min((int)bin.size() / 4, depth);
+		size_t p = bin.size() - n * 4;
+		for (int i = 0; i < n; i++) {
+			uint32_t v = 0;
+			for (int k = 0; k < 4; k++) {
+				v |= uint32_t(bin[p++]) << (k * 8);
+			}
+			std::memcpy(&data[c * MAX_DATA + i], &v, sizeof(v));
+		}
+		dataPtr[c] = std::max(n - 1, 0);
+		dataUsed[c] = n;
+	}
+
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "panelTheme", json_integer(panelTheme));
+		json_object_set_new(rootJ, "depth", json_integer(depth));
 
-		json_t* dataJ = json_array();
-		for (int i = 0; i < dataUsed; i++) {
-			json_t* d = json_real(data[i]);
-			json_array_append(dataJ, d);
+		// Trailing unused registers are omitted
+		int registers = PORT_MAX_CHANNELS;
+		while (registers > 1 && dataUsed[registers - 1] == 0) registers--;
+		json_t* registersJ = json_array();
+		for (int c = 0; c < registers; c++) {
+			json_array_append_new(registersJ, json_string(registerEncode(c).c_str()));
 		}
-		json_object_set_new(rootJ, "data", dataJ);
-
-		json_object_set_new(rootJ, "dataPtr", json_integer(dataPtr));
+		json_object_set_new(rootJ, "registers", registersJ);
 		return rootJ;
 	}
 
 	void dataFromJson(json_t *rootJ) override {
 		panelTheme = json_integer_value(json_object_get(rootJ, "panelTheme"));
 
+		json_t* depthJ = json_object_get(rootJ, "depth");
+		depth = depthJ ? clamp((int)json_integer_value(depthJ), 1, MAX_DATA) : MAX_DATA;
+		// Round down to a power of two
+		while (depth & (depth - 1)) depth &= depth - 1;
+
+		json_t* registersJ = json_object_get(rootJ, "registers");
+		if (registersJ) {
+			for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+				registerDecode(c, json_string_value(json_array_get(registersJ, c)));
+			}
+			return;
+		}
+
+		// Monophonic register of earlier versions
+		for (int c = 0; c < PORT_MAX_CHANNELS; c++) {
+			registerClear(c);
+		}
 		json_t* dataJ = json_object_get(rootJ, "data");
 		if (dataJ) {
 			json_t *d;
 			size_t dataIndex;
 			json_array_foreach(dataJ, dataIndex, d) {
+				if ((int)dataIndex >= MAX_DATA) break;
 				data[dataIndex] = json_real_value(d);
 			}
-			dataUsed = dataIndex;
+			dataUsed[0] = std::min((int)json_array_size(dataJ), MAX_DATA);
 		}
-
-		dataPtr = json_integer_value(json_object_get(rootJ, "dataPtr"));
+		dataPtr[0] = json_integer_value(json_object_get(rootJ, "dataPtr")) & (MAX_DATA - 1);
 	}
 };
 
@@ -160,6 +240,18 @@ struct SipoWidget : ThemedModuleWidget<SipoModule> {
 		addChild(w);
 		addOutput(createOutputCentered<StoermelderPort>(Vec(22.5f, 327.5f), module, SipoModule::POLY_OUTPUT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		ThemedModuleWidget<SipoModule>::appendContextMenu(menu);
+		SipoModule* module = dynamic_cast<SipoModule*>(this->module);
+
+		std::map<int, std::string> depths;
+		for (int i = 16; i <= MAX_DATA; i *= 2) {
+			depths[i] = string::f("%i", i);
+		}
+		menu->addChild(new MenuSeparator());
+		menu->addChild(StoermelderPackOne::Rack::createMapPtrSubmenuItem("Register depth", depths, &module->depth));
+	}
 };
 
 } // namespace Sipo
@@ -25,7 +25,10 @@ enum class SLOTCVMODE {
 	VOLT = 0,
 	C4 = 1,
 	ARM = 3,
-	PHASE = 11
+	PHASE = 11,
+	BLEND_WEIGHTS = 12,
+	BLEND_XY = 13,
+	BLEND_TRIANGLE = 14
 };
 
 enum class OUTMODE {
@@ -38,6 +41,128 @@ enum class OUTMODE {
 	PHASE = 5
 };
 
+/** Morphs the bound parameters between two sets of values. The parameters are resolved once into
+ * contiguous arrays, interpolation is done in blocks of four without any lookups.
+ */
+struct TransitMorph {
+	/** Consecutive parameters of the same module */
+	struct Group {
+		Module* module;
+		size_t begin;
+		size_t end;
+	};
+
+	std::vector<Group> groups;
+	std::vector<Param*> params;
+	/** Handles and their parameters at the time of resolve(), a parameter is written only as long as
+	 * its handle is still mapped to it */
+	std::vector<ParamHandle*> paramHandles;
+	std::vector<int> paramIds;
+	/** Padded to a multiple of 4 */
+	std::vector<float> from;
+	std::vector<float> to;
+	std::vector<float> out;
+	size_t count = 0;
+
+	void clear() {
+		groups.clear();
+		params.clear();
+		paramHandles.clear();
+		paramIds.clear();
+		count = 0;
+	}
+
+	/** Resolves the parameters of the handles, must be called whenever the mappings could have changed. */
+	template <class HANDLE>
+	void resolve(const std::vector<HANDLE*>& handles) {
+		groups.clear();
+		size_t n = std::min(count, handles.size());
+		for (size_t i = 0; i < n; i++) {
+			ParamHandle* handle = handles[i];
+			Module* m = handle->moduleId >= 0 ? handle->module : NULL;
+			if (m && handle->paramId >= (int)m->params.size()) m = NULL;
+			params[i] = m ? &m->params[handle->paramId] : NULL;
+			paramHandles[i] = handle;
+			paramIds[i] = handle->paramId;
+			if (groups.empty() || groups.back().module != m) groups.push_back({m, i, i});
+			groups.back().end = i + 1;
+		}
+	}
+
+	template <class HANDLE>
+	void prepare(const std::vector<HANDLE*>& handles) {
+		count = handles.size();
+		size_t c = (count + 3) & ~size_t(3);
+		params.resize(count);
+		paramHandles.resize(count);
+		paramIds.resize(count);
+		from.resize(c, 0.f);
+		to.resize(c, 0.f);
+		out.resize(c, 0.f);
+		resolve(handles);
+	}
+
+	/** Prepares a morph from the values in a to the values in b, missing values are taken from the parameters. */
+	template <class HANDLE>
+	void set(const std::vector<HANDLE*>& handles, const std::vector<float>* a, const std::vector<float>* b) {
+		prepare(handles);
+		for (size_t i = 0; i < count; i++) {
+			float v = params[i] ? params[i]->getValue() : 0.f;
+			from[i] = a && i < a->size() ? (*a)[i] : v;
+			to[i] = b && i < b->size() ? (*b)[i] : v;
+		}
+		std::fill(from.begin() + count, from.end(), 0.f);
+		std::fill(to.begin() + count, to.end(), 0.f);
+	}
+
+	/** Sets the parameters to crossfade(from, to, s), values close to an integer are snapped if requested. */
+	void process(float s, bool snap) {
+		simd::float_4 s4 = s;
+		for (size_t i = 0; i < count; i += 4) {
+			simd::float_4 a = simd::float_4::load(&from[i]);
+			simd::float_4 b = simd::float_4::load(&to[i]);
+			simd::float_4 v = a + (b - a) * s4;
+			if (snap) {
+				simd::float_4 r = simd::round(v);
+				v = simd::ifelse(simd::fabs(r - v) < 5e-3f, r, v);
+			}
+			v.store(&out[i]);
+		}
+		write();
+	}
+
+	/** Sets the parameters to the weighted sum of n rows, every row must hold at least count values. */
+	void blend(const float* const* rows, const float* weights, int n) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			simd::float_4 v = 0.f;
+			for (int k = 0; k < n; k++) {
+				v += simd::float_4::load(rows[k] + i) * weights[k];
+			}
+			v.store(&out[i]);
+		}
+		for (; i < count; i++) {
+			float v = 0.f;
+			for (int k = 0; k < n; k++) {
+				v += rows[k][i] * weights[k];
+			}
+			out[i] = v;
+		}
+		write();
+	}
+
+	void write() {
+		for (const Group& g : groups) {
+			if (!g.module) continue;
+			for (size_t i = g.begin; i < g.end; i++) {
+				// Any handle might have been remapped or unmapped since resolve()
+				if (paramHandles[i]->module != g.module || paramHandles[i]->paramId != paramIds[i]) continue;
+				params[i]->setValue(out[i]);
+			}
+		}
+	}
+}; // struct TransitMorph
+
 template <int NUM_PRESETS>
 struct TransitModule : TransitBase<NUM_PRESETS> {
 	typedef TransitBase<NUM_PRESETS> BASE;
@@ -79,9 +204,16 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 	int presetCopy = -1;
 	float presetPhaseLast = -1.f;
 
-	/** Holds the last values on transitions */
-	std::vector<float> presetOld;
-	std::vector<float> presetNew;
+	/** Holds the values on transitions */
+	TransitMorph morph;
+	/** Snapshots the morph has been prepared for in phase-mode */
+	int morphPhase1 = -1;
+	int morphPhase2 = -1;
+	/** Weights of the snapshots in blend-modes, used for the lights */
+	float blendWeight[(MAX_EXPANDERS + 1) * NUM_PRESETS] = {};
+	/** Weights of the last blend before normalization, blendCountLast is -1 if the blend must be applied again */
+	float blendWeightLast[PORT_MAX_CHANNELS];
+	int blendCountLast = -1;
 
 	/** [Stored to JSON] mode for SEQ CV input */
 	SLOTCVMODE slotCvMode = SLOTCVMODE::TRIG_FWD;
@@ -174,6 +306,8 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 					delete sourceHandle;
 				}
 				sourceHandles.clear();
+				morph.clear();
+				processing = false;
 				inChange = false;
 			};
 
@@ -203,7 +337,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 		outEocPulseGenerator.reset();
 
 		mappingIndicatorHidden = false;
-		presetProcessDivision = settings::isPlugin ? 256 : 64;
+		presetProcessDivision = 64;
 		presetProcessDivider.setDivision(presetProcessDivision);
 		presetProcessDivider.reset();
 		
@@ -272,6 +406,8 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 				sourceHandle->color = mappingIndicatorHidden ? color::BLACK_TRANSPARENT : nvgRGB(0x40, 0xff, 0xff);
 				sourceHandle->process(st);
 			}
+			// Pick up changed mappings of a running transition
+			if (processing || isPhaseCvActive() || isBlendCvActive()) morph.resolve(sourceHandles);
 		}
 
 		// Read & Auto mode
@@ -462,7 +598,10 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 
 		if (isPhaseCvActive() && BASE::ctrlMode == CTRLMODE::READ) {
 			presetProcessPhase(args.sampleTime);
-		} 
+		}
+		else if (isBlendCvActive() && BASE::ctrlMode == CTRLMODE::READ) {
+			presetProcessBlend();
+		}
 		else {
 			presetProcess(args.sampleTime);
 		}
@@ -480,7 +619,13 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 				TransitSlot* slot = expSlot(i);
 				bool u = *(slot->presetSlotUsed);
 				if (BASE::ctrlMode == CTRLMODE::READ || BASE::ctrlMode == CTRLMODE::AUTO) {
-					if (!isPhaseCvActive() || BASE::ctrlMode == CTRLMODE::AUTO) {
+					if (isBlendCvActive() && BASE::ctrlMode == CTRLMODE::READ) {
+						float f = blendWeight[i];
+						slot->lights[0].setBrightness(f);
+						slot->lights[1].setBrightness(std::max(f, presetCount > i ? (u ? 1.f : 0.25f) : 0.f));
+						slot->lights[2].setBrightness(f);
+					}
+					else if (!isPhaseCvActive() || BASE::ctrlMode == CTRLMODE::AUTO) {
 						slot->lights[0].setBrightness(preset == i ? 1.f : (presetNext == i ? 1.f : 0.f));
 						slot->lights[1].setBrightness(preset == i ? 1.f : (presetCount > i ? (u ? 1.f : 0.25f) : 0.f));
 						slot->lights[2].setBrightness(preset == i ? 1.f : 0.f);
@@ -500,7 +645,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 				}
 			}
 
-			BASE::lights[LIGHT_CV].setBrightness((slotCvMode == SLOTCVMODE::OFF || (slotCvMode == SLOTCVMODE::PHASE && BASE::ctrlMode == CTRLMODE::WRITE)) && lightBlink);
+			BASE::lights[LIGHT_CV].setBrightness((slotCvMode == SLOTCVMODE::OFF || ((slotCvMode == SLOTCVMODE::PHASE || isBlendCvMode()) && BASE::ctrlMode == CTRLMODE::WRITE)) && lightBlink);
 		}
 	}
 
@@ -508,6 +653,14 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 		return slotCvMode == SLOTCVMODE::PHASE && BASE::inputs[INPUT_CV].isConnected();
 	}
 
+	inline bool isBlendCvMode() {
+		return slotCvMode == SLOTCVMODE::BLEND_WEIGHTS || slotCvMode == SLOTCVMODE::BLEND_XY || slotCvMode == SLOTCVMODE::BLEND_TRIANGLE;
+	}
+
+	inline bool isBlendCvActive() {
+		return isBlendCvMode() && BASE::inputs[INPUT_CV].isConnected();
+	}
+
 	ParamQuantity* getParamQuantity(ParamHandle* handle) {
 		if (handle->moduleId < 0)
 			return NULL;
@@ -594,15 +747,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 				outSocPulseGenerator.trigger();
 				outEocArm = true;
 				processing = true;
-				presetOld.clear();
-				presetNew.clear();
-				for (size_t i = 0; i < sourceHandles.size(); i++) {
-					ParamQuantity* pq = getParamQuantity(sourceHandles[i]);
-					presetOld.push_back(pq ? pq->getValue() : 0.f);
-					if (slot->preset->size() > i) {
-						presetNew.push_back((*(slot->preset))[i]);
-					}
-				}
+				morph.set(sourceHandles, NULL, slot->preset);
 			}
 		}
 		else {
@@ -612,6 +757,8 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 	}
 
 	void presetProcess(float sampleTime) {
+		morphPhase1 = morphPhase2 = -1;
+		blendCountLast = -1;
 		if (processing && presetProcessDivider.process()) {
 			if (preset == -1) return;
 			float deltaTime = sampleTime * presetProcessDivision;
@@ -661,18 +808,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 			}
 
 			float s10 = s / 10.f;
-			for (size_t i = 0; i < sourceHandles.size(); i++) {
-				ParamQuantity* pq = getParamQuantity(sourceHandles[i]);
-				if (!pq) continue;
-				if (presetOld.size() <= i) return;
-				float oldValue = presetOld[i];
-				if (presetNew.size() <= i) return;
-				float newValue = presetNew[i];
-				float v = crossfade(oldValue, newValue, s10);
-				if (s10 > (1.f - 5e-3f) && std::abs(std::round(v) - v) < 5e-3f) v = std::round(v);
-				//pq->setValue(v);
-				pq->getParam()->setValue(v);
-			}
+			morph.process(s10, s10 > (1.f - 5e-3f));
 
 			if (s == 10.f) {
 				processing = false;
@@ -681,6 +817,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 	}
 
 	void presetProcessPhase(float sampleTime) {
+		blendCountLast = -1;
 		if (presetProcessDivider.process()) {
 			preset = -1;
 			float deltaTime = sampleTime * presetProcessDivision;
@@ -715,33 +852,98 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 			if (p1 < 0) { p1 = p2; slot1 = slot2; }
 			if (p2 >= presetCount) p2 = p1;
 			
-			if (p1 != p2) {
-				p = (p - float(p1)) / (float(p2) - float(p1));
-				for (size_t i = 0; i < sourceHandles.size(); i++) {
-					ParamQuantity* pq = getParamQuantity(sourceHandles[i]);
-					if (!pq) continue;
-					float v1 = (*slot1->preset)[i];
-					float v2 = (*slot2->preset)[i];
-					float v = crossfade(v1, v2, p);
-					//pq->setValue(v);
-					pq->getParam()->setValue(v);
-				}
-			}
-			else {
-				for (size_t i = 0; i < sourceHandles.size(); i++) {
-					ParamQuantity* pq = getParamQuantity(sourceHandles[i]);
-					if (!pq) continue;
-					float v = (*slot1->preset)[i];
-					//pq->setValue(v);
-					pq->getParam()->setValue(v);
-				}
+			if (p1 != morphPhase1 || p2 != morphPhase2 || morph.count != sourceHandles.size()) {
+				morph.set(sourceHandles, slot1->preset, slot2->preset);
+				morphPhase1 = p1;
+				morphPhase2 = p2;
 			}
+			morph.process(p1 != p2 ? (p - float(p1)) / (float(p2) - float(p1)) : 0.f, false);
 
 			BASE::outputs[OUTPUT].setVoltage(presetPhaseLast / (presetCount - 1) * 10.f);
 			BASE::outputs[OUTPUT].setChannels(1);
 		}
 	}
 
+	/** Blends up to 16 snapshots, the weights are taken from the CV input depending on the mode. */
+	void presetProcessBlend() {
+		if (!presetProcessDivider.process()) return;
+		preset = -1;
+		morphPhase1 = morphPhase2 = -1;
+
+		Input& in = BASE::inputs[INPUT_CV];
+		float w[PORT_MAX_CHANNELS];
+		int n = 0;
+		switch (slotCvMode) {
+			case SLOTCVMODE::BLEND_WEIGHTS: {
+				// Channel c sets the weight of snapshot c
+				n = in.getChannels();
+				for (int c = 0; c < n; c++) {
+					w[c] = clamp(in.getVoltage(c) / 10.f, 0.f, 1.f);
+				}
+				break;
+			}
+			case SLOTCVMODE::BLEND_XY: {
+				// Bilinear on a square of snapshots 1 (top-left), 2 (top-right), 3 (bottom-left), 4 (bottom-right)
+				float x = clamp(in.getVoltage(0) / 10.f, 0.f, 1.f);
+				// Y needs a second channel, a monophonic cable blends snapshots 1 and 2 only
+				float y = in.getChannels() >= 2 ? clamp(in.getVoltage(1) / 10.f, 0.f, 1.f) : 0.f;
+				w[0] = (1.f - x) * (1.f - y);
+				w[1] = x * (1.f - y);
+				w[2] = (1.f - x) * y;
+				w[3] = x * y;
+				n = 4;
+				break;
+			}
+			case SLOTCVMODE::BLEND_TRIANGLE: {
+				// Barycentric coordinates on a triangle of snapshots 1 (0V, 0V), 2 (10V, 0V) and 3 (5V, 10V)
+				float x = clamp(in.getVoltage(0) / 10.f, 0.f, 1.f);
+				// Y needs a second channel, a monophonic cable blends snapshots 1 and 2 only
+				float y = in.getChannels() >= 2 ? clamp(in.getVoltage(1) / 10.f, 0.f, 1.f) : 0.f;
+				w[2] = y;
+				w[1] = std::max(x - 0.5f * y, 0.f);
+				w[0] = std::max(1.f - w[1] - w[2], 0.f);
+				n = 3;
+				break;
+			}
+			default:
+				break;
+		}
+
+		// Nothing to do if neither the CV nor the snapshots have changed, like in phase-mode
+		bool changed = n != blendCountLast || morph.count != sourceHandles.size();
+		for (int i = 0; i < n && !changed; i++) {
+			changed = w[i] != blendWeightLast[i];
+		}
+		if (!changed) return;
+		std::copy(w, w + n, blendWeightLast);
+		blendCountLast = n;
+
+		// Skip unused snapshots and normalize the weights
+		if (morph.count != sourceHandles.size()) morph.prepare(sourceHandles);
+		const float* rows[PORT_MAX_CHANNELS];
+		float weights[PORT_MAX_CHANNELS];
+		int k = 0;
+		float sum = 0.f;
+		std::fill(blendWeight, blendWeight + presetTotal, 0.f);
+		for (int i = 0; i < std::min(n, presetCount); i++) {
+			TransitSlot* slot = expSlot(i);
+			if (w[i] <= 0.f || !*(slot->presetSlotUsed) || slot->preset->size() < morph.count) continue;
+			rows[k] = slot->preset->data();
+			weights[k] = w[i];
+			blendWeight[i] = w[i];
+			sum += w[i];
+			k++;
+		}
+		if (sum <= 0.f) return;
+		for (int i = 0; i < k; i++) {
+			weights[i] /= sum;
+		}
+		for (int i = 0; i < n; i++) {
+			blendWeight[i] /= sum;
+		}
+		morph.blend(rows, weights, k);
+	}
+
 	void presetSave(int p) {
 		TransitSlot* slot = expSlot(p);
 		*(slot->presetSlotUsed) = true;
@@ -767,6 +969,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 		if (preset >= p) preset = 0;
 		presetCount = p;
 		presetNext = -1;
+		blendCountLast = -1;
 	}
 
 	void presetRandomize(int p) {
@@ -844,6 +1047,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 		slotCvMode = slotCvModeBak = mode;
 		if (slotCvMode == SLOTCVMODE::PHASE) outMode = OUTMODE::PHASE;
 		else if (outMode == OUTMODE::PHASE) outMode = OUTMODE::ENV;
+		std::fill(std::begin(blendWeight), std::end(blendWeight), 0.f);
 	}
 
 	void setOutMode(OUTMODE mode) {
@@ -853,6 +1057,9 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 	}
 
 	int transitSlotCmd(SLOT_CMD cmd, int i) override {
+		// Snapshots might change, phase-mode needs to prepare the morph again
+		morphPhase1 = morphPhase2 = -1;
+		blendCountLast = -1;
 		switch (cmd) {
 			case SLOT_CMD::LOAD:
 				presetLoad(i); 
@@ -959,6 +1166,7 @@ struct TransitModule : TransitBase<NUM_PRESETS> {
 
 		BASE::dataFromJson(rootJ);
 		Module::params[PARAM_CTRLMODE].setValue(0.f);
+		blendCountLast = -1;
 	}
 };
 
@@ -1215,6 +1423,9 @@ struct TransitWidget : ThemedModuleWidget<TransitModule<NUM_PRESETS>> {
 			menu->addChild(construct<SlotCvModeItem>(&MenuItem::text, "Arm", &SlotCvModeItem::module, module, &SlotCvModeItem::slotCvMode, SLOTCVMODE::ARM));
 			menu->addChild(new MenuSeparator);
 			menu->addChild(construct<SlotCvModeItem>(&MenuItem::text, "Phase", &SlotCvModeItem::module, module, &SlotCvModeItem::slotCvMode, SLOTCVMODE::PHASE));
+			menu->addChild(construct<SlotCvModeItem>(&MenuItem::text, "Blend weights", &SlotCvModeItem::module, module, &SlotCvModeItem::slotCvMode, SLOTCVMODE::BLEND_WEIGHTS));
+			menu->addChild(construct<SlotCvModeItem>(&MenuItem::text, "Blend XY", &SlotCvModeItem::module, module, &SlotCvModeItem::slotCvMode, SLOTCVMODE::BLEND_XY));
+			menu->addChild(construct<SlotCvModeItem>(&MenuItem::text, "Blend triangle", &SlotCvModeItem::module, module, &SlotCvModeItem::slotCvMode, SLOTCVMODE::BLEND_TRIANGLE));
 			menu->addChild(new MenuSeparator);
 			menu->addChild(construct<SlotCvModeItem>(&MenuItem::text, "Off", &SlotCvModeItem::rightTextEx, RACK_MOD_SHIFT_NAME "+Q", &SlotCvModeItem::module, module, &SlotCvModeItem::slotCvMode, SLOTCVMODE::OFF));
 		}));
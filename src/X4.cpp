@@ -83,7 +83,7 @@ struct X4Module : CVMapModuleBase<2> {
 
 	void process(const ProcessArgs& args) override {
 		if (audioRate || processDivider.process()) {
-			ParamQuantity* pqA = getParamQuantity(0);
+			ParamQuantity* pqA = resolveParamQuantity(0);
 			if (pqA) {
 				float v = pqA->getScaledValue();
 				if (!isNear(v, lastA[0])) {
@@ -142,7 +142,7 @@ struct X4Module : CVMapModuleBase<2> {
 				}
 			}
 
-			ParamQuantity* pqB = getParamQuantity(1);
+			ParamQuantity* pqB = resolveParamQuantity(1);
 			if (pqB) {
 				float v = pqB->getScaledValue();
 				if (!isNear(v, lastB[0])) {
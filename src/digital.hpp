@@ -117,48 +117,161 @@ struct LinearFade {
 };
 
 
+/** Four LinearFade in the lanes of a float_4, each lane with its own rise and fall time. */
 struct LinearFade4 {
-	float rise = 1.f;
-	float fall = 1.f;
-	simd::float_4 currentRise;
-	simd::float_4 currentFall;
+	simd::float_4 rise = 1.f;
+	simd::float_4 fall = 1.f;
+	simd::float_4 currentRise = 1.f;
+	simd::float_4 currentFall = 0.f;
 	simd::float_4 last = 0.f;
 
 	void reset(int i, float last) {
-		currentRise[i] = rise;
+		currentRise[i] = rise[i];
 		currentFall[i] = 0.f;
 		this->last[i] = last;
 	}
 
 	void triggerFadeIn(int i) {
-		currentRise[i] = (currentFall[i] / fall) * rise;
+		currentRise[i] = (fall[i] > 0.f ? (currentFall[i] / fall[i]) : 0.f) * rise[i];
 		currentFall[i] = 0.f;
 		last[i] = 1.f;
 	}
 
 	void triggerFadeOut(int i) {
-		currentFall[i] = (currentRise[i] / rise) * fall;
-		currentRise[i] = rise;
+		currentFall[i] = (rise[i] > 0.f ? (currentRise[i] / rise[i]) : 0.f) * fall[i];
+		currentRise[i] = rise[i];
 		last[i] = 0.f;
 	}
 
-	inline void setRiseFall(float rise, float fall) {
-		currentRise = simd::ifelse(currentRise == this->rise, rise, currentRise);
-		currentFall = simd::fmin(fall, currentFall);
-		this->rise = rise;
-		this->fall = fall;
+	inline void setRise(int i, float rise) {
+		if (currentRise[i] == this->rise[i]) currentRise[i] = rise;
+		this->rise[i] = rise;
+	}
+
+	inline void setFall(int i, float fall) {
+		currentFall[i] = std::min(fall, currentFall[i]);
+		this->fall[i] = fall;
 	}
 
 	inline simd::float_4 process(float deltaTime) {
-		simd::float_4 r = last;
+		simd::float_4 rising = currentRise < rise;
+		simd::float_4 falling = ~rising & (currentFall > 0.f);
+		currentRise = simd::ifelse(rising, currentRise + deltaTime, currentRise);
+		currentFall = simd::ifelse(falling, simd::fmax(currentFall - deltaTime, 0.f), currentFall);
+
+		simd::float_4 r = simd::ifelse(rising, currentRise / rise, last);
+		return simd::ifelse(falling, currentFall / fall, r);
+	}
+};
+
+
+/** Four independent xorshift128 generators in the lanes of an int32_4. */
+struct Xorshift128_4 {
+	simd::int32_4 s[4];
+
+	Xorshift128_4() {
+		seed();
+	}
+
+	void seed() {
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				// The state must not be all zeros
+				s[i][j] = random::u32() | 1;
+			}
+		}
+	}
+
+	inline simd::int32_4 next() {
+		// Right shifts are masked as they might be arithmetic on signed lanes
+		simd::int32_4 t = s[0] ^ (s[0] << 11);
+		s[0] = s[1];
+		s[1] = s[2];
+		s[2] = s[3];
+		s[3] = s[3] ^ ((s[3] >> 19) & 0x1fff) ^ t ^ ((t >> 8) & 0xffffff);
+		return s[3];
+	}
+
+	/** Uniformly distributed in the open interval (0, 1) */
+	inline simd::float_4 uniform() {
+		simd::int32_4 r = (next() >> 8) & 0xffffff;
+		return (simd::float_4(r) + 0.5f) * (1.f / 16777216.f);
+	}
+};
 
-		r = simd::ifelse(currentRise < rise, currentRise / rise, r);
-		currentRise = simd::ifelse(currentRise < rise, currentRise += deltaTime, currentRise);
 
-		r = simd::ifelse(currentFall > 0.f, currentFall / fall, r);
-		currentFall = simd::ifelse(currentFall > 0.f, simd::fmax(currentFall - deltaTime, 0.f), currentFall);
+/** Polyphase FIR upsampler for four signals in the lanes of a float_4, same filter design as dsp::Upsampler. */
+template<int OVERSAMPLE, int QUALITY>
+struct Upsampler4 {
+	/** Input history, mirrored for reading QUALITY samples without wrapping */
+	simd::float_4 inBuffer[2 * QUALITY];
+	float kernel[OVERSAMPLE * QUALITY];
+	int inIndex;
 
-		return r;
+	Upsampler4(float cutoff = 0.9f) {
+		dsp::boxcarLowpassIR(kernel, OVERSAMPLE * QUALITY, cutoff * 0.5f / OVERSAMPLE);
+		dsp::blackmanHarrisWindow(kernel, OVERSAMPLE * QUALITY);
+		for (int i = 0; i < OVERSAMPLE * QUALITY; i++) {
+			kernel[i] *= OVERSAMPLE;
+		}
+		reset();
+	}
+
+	void reset() {
+		inIndex = 0;
+		for (int i = 0; i < 2 * QUALITY; i++) {
+			inBuffer[i] = 0.f;
+		}
+	}
+
+	/** Writes OVERSAMPLE samples to out */
+	inline void process(simd::float_4 in, simd::float_4* out) {
+		inIndex = (inIndex == 0 ? QUALITY : inIndex) - 1;
+		inBuffer[inIndex] = inBuffer[inIndex + QUALITY] = in;
+		for (int i = 0; i < OVERSAMPLE; i++) {
+			simd::float_4 y = 0.f;
+			for (int j = 0; j < QUALITY; j++) {
+				y += kernel[j * OVERSAMPLE + i] * inBuffer[inIndex + j];
+			}
+			out[i] = y;
+		}
+	}
+};
+
+
+/** FIR decimator for four signals in the lanes of a float_4, same filter design as dsp::Decimator. */
+template<int OVERSAMPLE, int QUALITY>
+struct Decimator4 {
+	static const int LENGTH = OVERSAMPLE * QUALITY;
+	/** Input history, mirrored for reading LENGTH samples without wrapping */
+	simd::float_4 inBuffer[2 * LENGTH];
+	float kernel[LENGTH];
+	int inIndex;
+
+	Decimator4(float cutoff = 0.9f) {
+		dsp::boxcarLowpassIR(kernel, LENGTH, cutoff * 0.5f / OVERSAMPLE);
+		dsp::blackmanHarrisWindow(kernel, LENGTH);
+		reset();
+	}
+
+	void reset() {
+		inIndex = 0;
+		for (int i = 0; i < 2 * LENGTH; i++) {
+			inBuffer[i] = 0.f;
+		}
+	}
+
+	/** Reads OVERSAMPLE samples from in, the filter is evaluated only once for the output sample */
+	inline simd::float_4 process(const simd::float_4* in) {
+		for (int i = 0; i < OVERSAMPLE; i++) {
+			inIndex = (inIndex == 0 ? LENGTH : inIndex) - 1;
+			inBuffer[inIndex] = inBuffer[inIndex + LENGTH] = in[i];
+		}
+		simd::float_4 y = 0.f;
+		for (int j = 0; j < LENGTH; j++) {
+			y += kernel[j] * inBuffer[inIndex + j];
+		}
+		return y;
 	}
 };
 
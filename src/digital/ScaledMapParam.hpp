@@ -108,7 +108,7 @@ struct ScaledMapParam {
 			if (value == -1.f) value = filter.out;
 			filterInitialized = true;
 		}
-		float f = filterSlew > 0.f && sampleTime > 0.f ? filter.process(sampleTime, value) : value;
+		float f = processValue(sampleTime);
 		if (valueOut != f || force) {
 			Param* param = paramQuantity->getParam();
 			if (param) {
@@ -124,6 +124,11 @@ struct ScaledMapParam {
 		}
 	}
 
+	/** Returns the value to be applied on the parameter for the current step. */
+	virtual float processValue(float sampleTime) {
+		return filterSlew > 0.f && sampleTime > 0.f ? filter.process(sampleTime, value) : value;
+	}
+
 	virtual T getValue() {
 		float f = paramQuantity->getScaledValue();
 		if (isNear(valueOut, f)) return valueIn;
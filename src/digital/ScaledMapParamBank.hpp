@@ -0,0 +1,193 @@
+#pragma once
+#include "plugin.hpp"
+#include "../helpers/ResolvedParam.hpp"
+
+namespace StoermelderPackOne {
+
+/** Bank of N float mappings with the same behavior as ScaledMapParam<float>, but the state of all
+ * channels is stored as arrays so process() steps four channels at once. Single channels are accessed
+ * by Channel which provides the interface of ScaledMapParam used by the menus and JSON-handling.
+ */
+template<int N>
+struct ScaledMapParamBank {
+	static_assert(N % 4 == 0, "N must be a multiple of 4");
+
+	struct Channel {
+		ScaledMapParamBank* bank;
+		int id;
+		ParamQuantity* paramQuantity = NULL;
+		float limitMin = 0.f;
+		float limitMax = 1.f;
+		float uninit = 0.f;
+		float filterSlew = 0.f;
+
+		void setLimits(float min, float max, float uninit) {
+			limitMin = bank->limitMin[id] = min;
+			limitMax = bank->limitMax[id] = max;
+			this->uninit = uninit;
+		}
+		float getLimitMin() {
+			return limitMin;
+		}
+		float getLimitMax() {
+			return limitMax;
+		}
+
+		void reset(bool resetSettings = true) {
+			paramQuantity = NULL;
+			bank->filterOut[id] = 0.f;
+			bank->filterInitialized[id] = false;
+			bank->valueIn[id] = uninit;
+			bank->value[id] = -1.f;
+			bank->valueOut[id] = std::numeric_limits<float>::infinity();
+
+			if (resetSettings) {
+				filterSlew = bank->slew[id] = 0.f;
+				bank->min[id] = 0.f;
+				bank->max[id] = 1.f;
+			}
+		}
+
+		void resetFilter() {
+			bank->filterOut[id] = 0.f;
+			bank->filterInitialized[id] = false;
+		}
+
+		void setParamQuantity(ParamQuantity* pq) {
+			paramQuantity = pq;
+			if (paramQuantity && bank->valueOut[id] == std::numeric_limits<float>::infinity()) {
+				bank->valueOut[id] = paramQuantity->getScaledValue();
+			}
+		}
+
+		void setSlew(float slew) {
+			filterSlew = bank->slew[id] = slew;
+			bank->lambda[id] = (1.f / slew) * 10.f;
+			if (filterSlew == 0.f) bank->filterInitialized[id] = false;
+		}
+		float getSlew() {
+			return filterSlew;
+		}
+
+		void setMin(float v) {
+			bank->min[id] = v;
+			if (paramQuantity && bank->valueIn[id] != -1) setValue(bank->valueIn[id]);
+		}
+		float getMin() {
+			return bank->min[id];
+		}
+
+		void setMax(float v) {
+			bank->max[id] = v;
+			if (paramQuantity && bank->valueIn[id] != -1) setValue(bank->valueIn[id]);
+		}
+		float getMax() {
+			return bank->max[id];
+		}
+
+		void setValue(float i) {
+			float f = rescale(i, limitMin, limitMax, bank->min[id], bank->max[id]);
+			bank->valueIn[id] = i;
+			bank->value[id] = clamp(f, 0.f, 1.f);
+		}
+
+		float getLightBrightness() {
+			if (!paramQuantity) return 0.f;
+			return bank->valueOut[id];
+		}
+	}; // struct Channel
+
+	alignas(16) float limitMin[N];
+	alignas(16) float limitMax[N];
+	alignas(16) float min[N];
+	alignas(16) float max[N];
+	alignas(16) float slew[N];
+	alignas(16) float lambda[N];
+	alignas(16) float filterOut[N];
+	alignas(16) float valueIn[N];
+	alignas(16) float value[N];
+	alignas(16) float valueOut[N];
+	bool filterInitialized[N];
+
+	Channel channels[N];
+
+	ScaledMapParamBank() {
+		for (int i = 0; i < N; i++) {
+			channels[i].bank = this;
+			channels[i].id = i;
+			lambda[i] = 0.f;
+			channels[i].setLimits(0.f, 1.f, 0.f);
+			channels[i].reset();
+		}
+	}
+
+	ScaledMapParamBank(const ScaledMapParamBank&) = delete;
+	ScaledMapParamBank& operator=(const ScaledMapParamBank&) = delete;
+
+	Channel& operator[](int i) {
+		return channels[i];
+	}
+
+	/** Same as setValue(in[i]) followed by process(deltaTime, force) of ScaledMapParam for the first n
+	 * channels, skipping channels with active[i] == false. Active channels must have their ParamQuantity
+	 * set and resolved[i] must be resolved to the same parameter. All arrays must hold N elements.
+	 */
+	void process(int n, const float* in, const bool* active, const ResolvedParam* resolved, float deltaTime, bool force) {
+		n = std::min((n + 3) & ~3, N);
+		alignas(16) float mask[N];
+		alignas(16) float pMin[N];
+		alignas(16) float pMax[N];
+		alignas(16) float snap[N];
+		alignas(16) float out[N];
+		for (int i = 0; i < n; i++) {
+			bool a = active[i] && valueOut[i] != std::numeric_limits<float>::infinity();
+			// Set filter from param value if filter is uninitialized
+			if (a && !filterInitialized[i]) {
+				filterOut[i] = channels[i].paramQuantity->getScaledValue();
+				filterInitialized[i] = true;
+			}
+			mask[i] = a;
+			pMin[i] = a ? resolved[i].minValue : 0.f;
+			pMax[i] = a ? resolved[i].maxValue : 0.f;
+			snap[i] = a && resolved[i].snapEnabled;
+		}
+
+		simd::float_4 slewOn = deltaTime > 0.f ? simd::float_4::mask() : simd::float_4::zero();
+		for (int i = 0; i < n; i += 4) {
+			simd::float_4 m4 = simd::float_4::load(&mask[i]) > 0.f;
+			simd::float_4 t4 = simd::float_4::load(&in[i]);
+			simd::float_4 lLo4 = simd::float_4::load(&limitMin[i]);
+			simd::float_4 lHi4 = simd::float_4::load(&limitMax[i]);
+			simd::float_4 lo4 = simd::float_4::load(&min[i]);
+			simd::float_4 hi4 = simd::float_4::load(&max[i]);
+			simd::float_4 f4 = simd::clamp(lo4 + (t4 - lLo4) / (lHi4 - lLo4) * (hi4 - lo4), 0.f, 1.f);
+
+			// dsp::ExponentialSlewLimiter with equal rise and fall
+			simd::float_4 s4 = slewOn & (simd::float_4::load(&slew[i]) > 0.f);
+			simd::float_4 fo4 = simd::float_4::load(&filterOut[i]);
+			simd::float_4 y4 = fo4 + (f4 - fo4) * simd::float_4::load(&lambda[i]) * deltaTime;
+			y4 = simd::ifelse(fo4 == y4, f4, y4);
+			simd::float_4 o4 = simd::ifelse(s4, y4, f4);
+
+			simd::ifelse(m4, t4, simd::float_4::load(&valueIn[i])).store(&valueIn[i]);
+			simd::ifelse(m4, f4, simd::float_4::load(&value[i])).store(&value[i]);
+			simd::ifelse(m4 & s4, y4, fo4).store(&filterOut[i]);
+
+			simd::float_4 vo4 = simd::float_4::load(&valueOut[i]);
+			simd::float_4 changed = force ? m4 : (m4 & (vo4 != o4));
+			simd::ifelse(changed, o4, vo4).store(&valueOut[i]);
+
+			simd::float_4 pMin4 = simd::float_4::load(&pMin[i]);
+			simd::float_4 v4 = pMin4 + o4 * (simd::float_4::load(&pMax[i]) - pMin4);
+			v4 = simd::ifelse(simd::float_4::load(&snap[i]) > 0.f, simd::round(v4), v4);
+			v4.store(&out[i]);
+
+			int bits = simd::movemask(changed);
+			for (int j = 0; j < 4; j++) {
+				if (bits & (1 << j)) resolved[i + j].param->setValue(out[i + j]);
+			}
+		}
+	}
+}; // struct ScaledMapParamBank
+
+} // namespace StoermelderPackOne
\ No newline at end of file
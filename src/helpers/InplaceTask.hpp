@@ -0,0 +1,62 @@
+#pragma once
+#include "../plugin.hpp"
+#include <new>
+#include <type_traits>
+
+namespace StoermelderPackOne {
+
+/** Type-erased callable which is stored inline, so no heap-allocation takes place.
+ * Callables exceeding SIZE bytes are rejected at compile time.
+ */
+template<size_t SIZE>
+struct InplaceTask {
+	typename std::aligned_storage<SIZE, alignof(std::max_align_t)>::type storage;
+	void (*invokeFn)(void*) = NULL;
+	void (*destroyFn)(void*) = NULL;
+	void (*moveFn)(void*, void*) = NULL;
+
+	~InplaceTask() {
+		clear();
+	}
+
+	template<typename F>
+	void set(F&& f) {
+		typedef typename std::decay<F>::type T;
+		static_assert(sizeof(T) <= SIZE, "Task exceeds the inline storage, capture less or by pointer");
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Task is over-aligned");
+		clear();
+		new (&storage) T(std::forward<F>(f));
+		invokeFn = [](void* p) { (*reinterpret_cast<T*>(p))(); };
+		destroyFn = [](void* p) { reinterpret_cast<T*>(p)->~T(); };
+		moveFn = [](void* dst, void* src) { new (dst) T(std::move(*reinterpret_cast<T*>(src))); };
+	}
+
+	/** Moves the stored callable into another InplaceTask, this one is empty afterwards. */
+	void moveTo(InplaceTask& other) {
+		other.clear();
+		if (!invokeFn) return;
+		moveFn(&other.storage, &storage);
+		other.invokeFn = invokeFn;
+		other.destroyFn = destroyFn;
+		other.moveFn = moveFn;
+		clear();
+	}
+
+	bool empty() {
+		return invokeFn == NULL;
+	}
+
+	void run() {
+		if (invokeFn) invokeFn(&storage);
+		clear();
+	}
+
+	void clear() {
+		if (destroyFn) destroyFn(&storage);
+		invokeFn = NULL;
+		destroyFn = NULL;
+		moveFn = NULL;
+	}
+}; // struct InplaceTask
+
+} // namespace StoermelderPackOne
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include "../plugin.hpp"
+#include <atomic>
+
+namespace StoermelderPackOne {
+
+/** Replacement for midi::InputQueue which drops unwanted messages on the driver's thread and hands
+ * the remaining ones to the engine through a bounded lock-free queue (Dmitry Vyukov's bounded queue,
+ * as in TaskProcessor). The driver parses each device's stream once and passes every message to all
+ * ports subscribed to the device, filtering by channel; the status filter discards e.g. MIDI clock
+ * before it reaches the queue of a module which ignores it. The slots are preallocated, popping never
+ * takes a lock or allocates memory. Messages which don't fit into the queue are dropped.
+ */
+template<size_t SIZE = 1024>
+struct MidiInputQueue : midi::Input {
+	static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+	static const uint16_t STATUS_ALL = 0xff00;
+	static const uint16_t STATUS_NOTE = (1 << 0x8) | (1 << 0x9);
+	static const uint16_t STATUS_CC = 1 << 0xb;
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		midi::Message message;
+	};
+
+	Cell cells[SIZE];
+	std::atomic<size_t> enqueuePos;
+	size_t dequeuePos = 0;
+	/** Bitmask of accepted status nibbles 0x8 - 0xf, set before the port is connected to a device */
+	uint16_t statusMask;
+
+	MidiInputQueue(uint16_t statusMask = STATUS_ALL) {
+		this->statusMask = statusMask;
+		for (size_t i = 0; i < SIZE; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		enqueuePos.store(0, std::memory_order_relaxed);
+	}
+
+	/** Called by the driver, possibly from different threads while the device is switched. */
+	void onMessage(const midi::Message& message) override {
+		if (message.bytes.empty() || !(statusMask & (1 << message.getStatus()))) return;
+		Cell* cell;
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &cells[pos & (SIZE - 1)];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0) {
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (dif < 0) {
+				return;
+			}
+			else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		// Reuses the capacity of the slot, only SysEx messages may allocate
+		cell->message = message;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+	}
+
+	/** Same as midi::InputQueue::tryPop(), must be called from one thread only, usually the engine's. */
+	bool tryPop(midi::Message* messageOut, int64_t maxFrame) {
+		Cell* cell = &cells[dequeuePos & (SIZE - 1)];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) return false;
+		if (cell->message.frame > maxFrame) return false;
+		*messageOut = cell->message;
+		cell->sequence.store(dequeuePos + SIZE, std::memory_order_release);
+		dequeuePos++;
+		return true;
+	}
+}; // struct MidiInputQueue
+
+} // namespace StoermelderPackOne
\ No newline at end of file
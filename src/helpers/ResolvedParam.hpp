@@ -0,0 +1,39 @@
+#pragma once
+#include "../plugin.hpp"
+
+namespace StoermelderPackOne {
+
+/** Resolution of a ParamHandle to its bounded ParamQuantity, keeping the Param and the range
+ * the mapping loops need next to each other, e.g. for ScaledMapParamBank. The ParamQuantity is
+ * looked up on every call and the range is read again, as some modules replace their
+ * ParamQuantities or change their ranges at runtime. Must be used from one thread only, usually
+ * the engine's.
+ */
+struct ResolvedParam {
+	/** NULL if the handle is unmapped or the parameter is unbounded */
+	ParamQuantity* paramQuantity = NULL;
+	Param* param = NULL;
+	float minValue = 0.f;
+	float maxValue = 1.f;
+	bool snapEnabled = false;
+
+	inline ParamQuantity* resolve(const ParamHandle* handle) {
+		paramQuantity = NULL;
+		param = NULL;
+
+		Module* module = handle->module;
+		int paramId = handle->paramId;
+		if (handle->moduleId < 0 || !module) return NULL;
+		if (paramId < 0 || paramId >= (int)module->paramQuantities.size()) return NULL;
+		ParamQuantity* pq = module->paramQuantities[paramId];
+		if (!pq || !pq->isBounded()) return NULL;
+		paramQuantity = pq;
+		param = &module->params[paramId];
+		minValue = pq->getMinValue();
+		maxValue = pq->getMaxValue();
+		snapEnabled = pq->snapEnabled;
+		return paramQuantity;
+	}
+}; // struct ResolvedParam
+
+} // namespace StoermelderPackOne
\ No newline at end of file
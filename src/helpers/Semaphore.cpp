@@ -0,0 +1,74 @@
+#include "Semaphore.hpp"
+#if defined ARCH_WIN
+#include <windows.h>
+#include <climits>
+#elif defined ARCH_MAC
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#include <cerrno>
+#endif
+
+namespace StoermelderPackOne {
+
+#if defined ARCH_WIN
+
+Semaphore::Semaphore() {
+	handle = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+}
+
+Semaphore::~Semaphore() {
+	CloseHandle((HANDLE)handle);
+}
+
+void Semaphore::post() {
+	ReleaseSemaphore((HANDLE)handle, 1, NULL);
+}
+
+void Semaphore::wait() {
+	WaitForSingleObject((HANDLE)handle, INFINITE);
+}
+
+#elif defined ARCH_MAC
+
+// Unnamed POSIX semaphores are not supported on macOS
+Semaphore::Semaphore() {
+	handle = dispatch_semaphore_create(0);
+}
+
+Semaphore::~Semaphore() {
+	dispatch_release((dispatch_semaphore_t)handle);
+}
+
+void Semaphore::post() {
+	dispatch_semaphore_signal((dispatch_semaphore_t)handle);
+}
+
+void Semaphore::wait() {
+	dispatch_semaphore_wait((dispatch_semaphore_t)handle, DISPATCH_TIME_FOREVER);
+}
+
+#else
+
+Semaphore::Semaphore() {
+	sem_t* s = new sem_t;
+	sem_init(s, 0, 0);
+	handle = s;
+}
+
+Semaphore::~Semaphore() {
+	sem_destroy((sem_t*)handle);
+	delete (sem_t*)handle;
+}
+
+void Semaphore::post() {
+	sem_post((sem_t*)handle);
+}
+
+void Semaphore::wait() {
+	while (sem_wait((sem_t*)handle) != 0 && errno == EINTR);
+}
+
+#endif
+
+} // namespace StoermelderPackOne
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace StoermelderPackOne {
+
+/** Counting semaphore of the operating system. Unlike std::condition_variable a post() is never
+ * lost and needs no mutex, so it can be called from the engine's thread.
+ */
+struct Semaphore {
+	void* handle;
+
+	Semaphore();
+	~Semaphore();
+	/** Increments the count and wakes up one waiting thread, lock-free in the uncontended case. */
+	void post();
+	/** Blocks until the count is positive and decrements it. */
+	void wait();
+}; // struct Semaphore
+
+} // namespace StoermelderPackOne
\ No newline at end of file
@@ -1,24 +1,85 @@
 #pragma once
 #include "../plugin.hpp"
+#include "InplaceTask.hpp"
+#include <atomic>
 
 namespace StoermelderPackOne {
 
-template<size_t SIZE = 8>
+/** Bounded lock-free multi-producer/single-consumer task queue, based on Dmitry Vyukov's bounded queue.
+ * Tasks can be enqueued from any thread (e.g. the engine's thread) and are executed by the thread
+ * calling process() (usually the UI-thread). Enqueueing never allocates memory, tasks which
+ * don't fit into the queue are dropped and counted.
+ */
+template<size_t SIZE = 16, size_t TASK_SIZE = 48>
 struct TaskProcessor {
-    dsp::RingBuffer<std::function<void()>, SIZE> queue;
-
-    void process() {
-        while (queue.size() > 0) {
-            std::function<void()> t = queue.shift();
-            t();
-        }
-    }
-
-    void enqueue(std::function<void()> t) {
-        if (!queue.full()) {
-            queue.push(t);
-        }
-    }
+	static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		InplaceTask<TASK_SIZE> task;
+	};
+
+	Cell cells[SIZE];
+	std::atomic<size_t> enqueuePos;
+	size_t dequeuePos = 0;
+	/** Number of tasks dropped because the queue was full */
+	std::atomic<uint32_t> overflowCount;
+	uint32_t overflowReported = 0;
+
+	TaskProcessor() {
+		for (size_t i = 0; i < SIZE; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		enqueuePos.store(0, std::memory_order_relaxed);
+		overflowCount.store(0, std::memory_order_relaxed);
+	}
+
+	/** Executes all pending tasks, must be called from one thread only. */
+	void process() {
+		while (true) {
+			Cell* cell = &cells[dequeuePos & (SIZE - 1)];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) break;
+			cell->task.run();
+			cell->sequence.store(dequeuePos + SIZE, std::memory_order_release);
+			dequeuePos++;
+		}
+
+		uint32_t overflow = overflowCount.load(std::memory_order_relaxed);
+		if (overflow != overflowReported) {
+			WARN("TaskProcessor: %u task(s) dropped, queue of size %i is full", overflow - overflowReported, (int)SIZE);
+			overflowReported = overflow;
+		}
+	}
+
+	/** Thread-safe and allocation-free. Returns false if the task has been dropped. */
+	template<typename F>
+	bool enqueue(F&& f) {
+		Cell* cell;
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &cells[pos & (SIZE - 1)];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0) {
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (dif < 0) {
+				overflowCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		cell->task.set(std::forward<F>(f));
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	uint32_t getOverflowCount() {
+		return overflowCount.load(std::memory_order_relaxed);
+	}
 }; // struct TaskProcessor
 
 } // namespace StoermelderPackOne
\ No newline at end of file
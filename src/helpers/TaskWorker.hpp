@@ -1,51 +1,226 @@
 #pragma once
 #include "../plugin.hpp"
-#include <functional>
+#include "InplaceTask.hpp"
+#include "Semaphore.hpp"
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 
 namespace StoermelderPackOne {
 
+struct TaskWorker;
+
+/** Plugin-wide pool of worker threads shared by all TaskWorkers. The threads are started
+ * with the first TaskWorker and joined when the last one is destroyed, the number of threads
+ * is bounded regardless of the number of modules in the patch.
+ */
+struct TaskWorkerPool {
+	std::mutex mutex;
+	/** Posted once for every TaskWorker scheduled, the threads wait on it without a timeout */
+	Semaphore workSem;
+	/** Signaled whenever a TaskWorker has become idle */
+	std::condition_variable idleCondVar;
+	std::vector<std::thread> threads;
+	bool isRunning = false;
+	int refCount = 0;
+	/** Lock-free stack of TaskWorkers scheduled by work(), moved to the list below by the threads */
+	std::atomic<TaskWorker*> ready;
+	/** Intrusive list of scheduled TaskWorkers in order, guarded by the mutex */
+	TaskWorker* head = NULL;
+	TaskWorker* tail = NULL;
+
+	TaskWorkerPool() {
+		ready.store(NULL);
+	}
+
+	static TaskWorkerPool& instance() {
+		static TaskWorkerPool pool;
+		return pool;
+	}
+
+	static int threadCount() {
+		return clamp((int)std::thread::hardware_concurrency() / 2, 1, 4);
+	}
+
+	void acquire() {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (refCount++ > 0) return;
+		isRunning = true;
+		for (int i = 0; i < threadCount(); i++) {
+			threads.push_back(std::thread(&TaskWorkerPool::processWorker, this));
+		}
+	}
+
+	void release() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--refCount > 0) return;
+			isRunning = false;
+		}
+		for (size_t i = 0; i < threads.size(); i++) {
+			workSem.post();
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+		threads.clear();
+	}
+
+	/** Lock-free, safe to call from the engine's thread. */
+	void schedule(TaskWorker* w);
+
+	// Following methods must be called with the mutex locked
+
+	void push(TaskWorker* w);
+	TaskWorker* pop();
+
+	void processWorker();
+}; // struct TaskWorkerPool
+
+
+/** Per-module handle for running tasks on the TaskWorkerPool. Tasks of one TaskWorker are
+ * executed in order and never concurrently. Tasks are coalesced: if new tasks are submitted
+ * while the previous one is still pending only the latest one is executed.
+ */
 struct TaskWorker {
-	std::mutex workerMutex;
-	std::condition_variable workerCondVar;
-	std::thread* worker;
-	Context* workerContext;
-	bool workerIsRunning = true;
-	bool workerDoProcess = false;
-	int workerPreset = -1;
-	std::function<void()> workerTask;
+	static const size_t TASK_SIZE = 48;
+
+	/** Enough for the UI- and the engine-thread submitting at the same time, plus the latest
+	 * task and the one running */
+	static const int SLOTS = 4;
+
+	Context* context;
+	InplaceTask<TASK_SIZE> slots[SLOTS];
+	std::atomic<bool> slotUsed[SLOTS];
+	/** Slot of the latest task which has not been started yet, -1 if none. The thread taking a
+	 * slot out of here by exchange owns it until it releases it by slotUsed */
+	std::atomic<int> latest;
+	/** Set while this TaskWorker is queued in the pool or one of its tasks is running */
+	std::atomic<bool> isScheduled;
+	/** Guarded by the pool's mutex */
+	bool isCancelled = false;
+	TaskWorker* next = NULL;
 
 	TaskWorker() {
-		workerContext = contextGet();
-		worker = new std::thread(&TaskWorker::processWorker, this);
+		context = contextGet();
+		for (int i = 0; i < SLOTS; i++) {
+			slotUsed[i].store(false);
+		}
+		latest.store(-1);
+		isScheduled.store(false);
+		TaskWorkerPool::instance().acquire();
 	}
 
 	~TaskWorker() {
-		workerIsRunning = false;
-		workerDoProcess = true;
-		workerCondVar.notify_one();
-		worker->join();
-		workerContext = NULL;
-		delete worker;
+		TaskWorkerPool& pool = TaskWorkerPool::instance();
+		{
+			std::unique_lock<std::mutex> lock(pool.mutex);
+			// Pending tasks are dropped by the thread picking up this TaskWorker
+			isCancelled = true;
+			pool.idleCondVar.wait(lock, [this]() { return !isScheduled.load(); });
+		}
+		pool.release();
 	}
 
-	void processWorker() {
-		contextSet(workerContext);
-		while (true) {
-			std::unique_lock<std::mutex> lock(workerMutex);
-			workerCondVar.wait(lock, std::bind(&TaskWorker::workerDoProcess, this));
-			if (!workerIsRunning) return;
-			workerTask();
-			workerDoProcess = false;
+	/** Thread-safe, lock-free and allocation-free, so it can be called from the engine's thread.
+	 * Returns false if the task has been dropped as all slots are taken by concurrent calls. */
+	template<typename F>
+	bool work(F&& f) {
+		int i = 0;
+		for (; i < SLOTS; i++) {
+			bool expected = false;
+			if (slotUsed[i].compare_exchange_strong(expected, true)) break;
 		}
+		if (i == SLOTS) {
+			// Take over the slot of the latest task, it is superseded anyway
+			i = latest.exchange(-1);
+			if (i < 0) return false;
+			slots[i].clear();
+		}
+		slots[i].set(std::forward<F>(f));
+		int prev = latest.exchange(i);
+		// The previous task has been superseded before it was started
+		if (prev >= 0) {
+			slots[prev].clear();
+			slotUsed[prev].store(false);
+		}
+		// A scheduled TaskWorker checks for new tasks when its current task has finished
+		if (isScheduled.exchange(true)) return true;
+		TaskWorkerPool::instance().schedule(this);
+		return true;
+	}
+}; // struct TaskWorker
+
+
+inline void TaskWorkerPool::schedule(TaskWorker* w) {
+	TaskWorker* h = ready.load();
+	do {
+		w->next = h;
+	} while (!ready.compare_exchange_weak(h, w));
+	workSem.post();
+}
+
+inline void TaskWorkerPool::push(TaskWorker* w) {
+	w->next = NULL;
+	if (tail) tail->next = w;
+	else head = w;
+	tail = w;
+}
+
+inline TaskWorker* TaskWorkerPool::pop() {
+	// Take over all TaskWorkers scheduled by now, the stack holds them in reverse order
+	TaskWorker* r = ready.exchange(NULL);
+	TaskWorker* prev = NULL;
+	while (r) {
+		TaskWorker* n = r->next;
+		r->next = prev;
+		prev = r;
+		r = n;
 	}
+	while (prev) {
+		TaskWorker* n = prev->next;
+		push(prev);
+		prev = n;
+	}
+
+	TaskWorker* w = head;
+	if (!w) return NULL;
+	head = w->next;
+	if (!head) tail = NULL;
+	w->next = NULL;
+	return w;
+}
 
-	void work(std::function<void()> task) {
-		workerTask = task;
-		workerDoProcess = true;
-		workerCondVar.notify_one();
+inline void TaskWorkerPool::processWorker() {
+	while (true) {
+		workSem.wait();
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!isRunning) return;
+		// Posts left over from a previous start of the pool find nothing to do
+		TaskWorker* w = pop();
+		if (!w) continue;
+		bool isCancelled = w->isCancelled;
+		lock.unlock();
+
+		int i = w->latest.exchange(-1);
+		if (i >= 0) {
+			if (!isCancelled) {
+				contextSet(w->context);
+				w->slots[i].run();
+			}
+			w->slots[i].clear();
+			w->slotUsed[i].store(false);
+		}
+
+		lock.lock();
+		w->isScheduled.store(false);
+		// Tasks submitted while running didn't schedule the TaskWorker again
+		if (w->latest.load() >= 0 && !w->isScheduled.exchange(true)) {
+			push(w);
+			workSem.post();
+		}
+		idleCondVar.notify_all();
 	}
-}; // struct TaskWorker
+}
 
 } // namespace StoermelderPackOne
\ No newline at end of file